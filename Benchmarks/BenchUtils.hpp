@@ -0,0 +1,55 @@
+/**
+ ******************************************************************************
+ * File Name          : BenchUtils.hpp
+ * Description        : Timing helpers shared by the host benchmarks. Costs are
+ *    reported in host timestamp counter cycles (DWT->CYCCNT on the host port)
+ *    and in nanoseconds.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_BENCHMARKS_BENCH_UTILS_H
+#define CUBE_PLUSPLUS_BENCHMARKS_BENCH_UTILS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <cstdint>
+#include <cstdio>
+#include "SystemDefines.hpp"
+
+/* Functions -----------------------------------------------------------------*/
+namespace Bench
+{
+    constexpr uint8_t NUM_RUNS = 7;    // Runs per measurement, the fastest run is reported
+
+    inline uint32_t Cycles() { return DWT->CYCCNT; }
+
+    inline double CyclesToNs(double cycles) { return cycles * 1e9 / SystemCoreClock; }
+
+    /**
+     * @brief Runs fn iterations times per run and returns the fastest run in cycles per iteration. The
+     *        fastest run is the one least disturbed by the host OS.
+     * @param iterations Calls of fn per run, keep a run below ~1s so the 32-bit counter does not wrap
+     * @param fn Function to measure, called with the iteration index
+     */
+    template<typename FN>
+    double MeasureCycles(uint32_t iterations, FN&& fn)
+    {
+        double best = 0;
+        for (uint8_t run = 0; run < NUM_RUNS; run++) {
+            const uint32_t start = Cycles();
+            for (uint32_t i = 0; i < iterations; i++) {
+                fn(i);
+            }
+            const double perIteration = static_cast<double>(Cycles() - start) / iterations;
+            if (run == 0 || perIteration < best) {
+                best = perIteration;
+            }
+        }
+        return best;
+    }
+
+    inline void PrintHeader(const char* title)
+    {
+        printf("\n%s (host, %lu MHz counter)\n", title, static_cast<unsigned long>(SystemCoreClock / 1000000));
+    }
+}
+
+#endif // CUBE_PLUSPLUS_BENCHMARKS_BENCH_UTILS_H
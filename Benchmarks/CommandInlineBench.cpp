@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ * File Name          : CommandInlineBench.cpp
+ * Description        : Inline Command payload benchmark. For several payload sizes
+ *    a Command is filled with CopyDataToCommand, sent through a Queue,
+ *    received and reset. Reports the payload allocations per message, the
+ *    size of one queue item and the cycles per message. Build once per
+ *    COMMAND_INLINE_DATA_SIZE (see Benchmarks/README.md).
+ ******************************************************************************
+*/
+#include "BenchUtils.hpp"
+#include "Core/Inc/Queue.hpp"
+
+/* Constants -----------------------------------------------------------------*/
+constexpr uint32_t NUM_MESSAGES = 200000;
+constexpr uint16_t PAYLOAD_SIZES[] = { 0, 2, 4, 8, 16, 32 };
+
+/* Functions -----------------------------------------------------------------*/
+int main()
+{
+    Bench::PrintHeader("Command payload send / receive / reset");
+    printf("COMMAND_INLINE_DATA_SIZE %d, sizeof(Command) %u B\n", COMMAND_INLINE_DATA_SIZE,
+           static_cast<unsigned>(sizeof(Command)));
+    printf("%8s %14s %12s %12s %12s\n", "payload", "allocs/msg", "copy/msg", "cycles/msg", "ns/msg");
+
+    Queue queue(8);
+    uint8_t payload[32] = {};
+
+    for (uint16_t size : PAYLOAD_SIZES) {
+        uint32_t allocations = 0;
+        const double cycles = Bench::MeasureCycles(NUM_MESSAGES, [&](uint32_t) {
+            Command cm(DATA_COMMAND, size);
+            if (size > 0) {
+                cm.CopyDataToCommand(payload, size);
+                allocations += (cm.GetDataMode() == COMMAND_DATA_ALLOCATED) ? 1 : 0;
+            }
+            queue.Send(cm);
+
+            Command received;
+            queue.Receive(received);
+            received.Reset();
+        });
+
+        // Every message is copied into and out of the RTOS queue
+        printf("%6u B %14.2f %10u B %12.1f %12.1f\n", size,
+               static_cast<double>(allocations) / (NUM_MESSAGES * Bench::NUM_RUNS),
+               static_cast<unsigned>(2 * sizeof(Command)), cycles, Bench::CyclesToNs(cycles));
+    }
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+/**
+ ******************************************************************************
+ * File Name          : CubePrintBench.cpp
+ * Description        : CUBE_PRINT per message cost and pool usage. Compares
+ *    cube_print (formats into a CommandLoan of DEBUG_PRINT_MAX_SIZE, trimmed
+ *    to a block sized to the message at commit) with the copying path it
+ *    replaced (format into a stack buffer, then CopyDataToCommand). The Cube
+ *    task queue is drained by the benchmark, no task runs.
+ ******************************************************************************
+*/
+#include <cstdarg>
+#include "BenchUtils.hpp"
+#include "Core/Inc/CommandPool.hpp"
+#include "CubeTask.hpp"
+
+/* Constants -----------------------------------------------------------------*/
+constexpr uint32_t NUM_MESSAGES = 50000;
+constexpr uint16_t BURST_SIZE = UART_TASK_QUEUE_DEPTH_OBJS;    // Prints queued before the Cube task runs
+
+/* Functions -----------------------------------------------------------------*/
+namespace
+{
+    /**
+     * @brief Print path before the loan API, formats into a stack buffer and copies it into the Command
+     */
+    void CopyPrint(const char* str, ...)
+    {
+        char buffer[DEBUG_PRINT_MAX_SIZE];
+        Global::vaListMutex.Lock(DEBUG_TAKE_MAX_TIME_MS);
+        va_list argument_list;
+        va_start(argument_list, str);
+        int16_t buflen = vsnprintf(buffer, sizeof(buffer), str, argument_list);
+        va_end(argument_list);
+        Global::vaListMutex.Unlock();
+
+        if (buflen >= static_cast<int16_t>(sizeof(buffer))) {
+            buflen = sizeof(buffer) - 1;
+        }
+        Command cmd(DATA_COMMAND, CUBE_TASK_COMMAND_SEND_DEBUG);
+        cmd.CopyDataToCommand(reinterpret_cast<uint8_t*>(buffer), buflen);
+        CubeTask::Inst().GetEventQueue()->Send(cmd, false);
+    }
+
+    void Drain()
+    {
+        Command cm;
+        while (CubeTask::Inst().GetEventQueue()->Receive(cm)) {
+            cm.Reset();
+        }
+    }
+
+    template<typename PRINT>
+    void Run(const char* name, PRINT&& print)
+    {
+        const double shortCycles = Bench::MeasureCycles(NUM_MESSAGES, [&](uint32_t i) {
+            print("Sensor %d: %d\r\n", 3, static_cast<int>(i));
+            Drain();
+        });
+        const double longCycles = Bench::MeasureCycles(NUM_MESSAGES, [&](uint32_t i) {
+            print("STATE - transition from %s to %s after %d ms, pressure %d kPa, temperature %d C, flags 0x%08x\r\n",
+                  "PRELAUNCH", "FILL", static_cast<int>(i), 101, 23, 0xA5u);
+            Drain();
+        });
+
+        // A burst of short prints queued before the Cube task gets to run
+        const uint16_t fallbacksBefore = CommandPool::GetHeapFallbackCount();
+        for (uint16_t i = 0; i < BURST_SIZE; i++) {
+            print("Sensor %d: %d\r\n", 3, static_cast<int>(i));
+        }
+        const uint16_t fallbacks = CommandPool::GetHeapFallbackCount() - fallbacksBefore;
+        const uint16_t largeFree = CommandPool::GetAvailableBlocks(COMMAND_POOL_LARGE);
+        Drain();
+
+        printf("%-12s %10.0f %10.0f %14u %16u\n", name, shortCycles, longCycles, fallbacks, largeFree);
+    }
+}
+
+int main()
+{
+    Bench::PrintHeader("CUBE_PRINT per message");
+    printf("short = 16 chars, long = 118 chars, burst = %u short prints queued\n", BURST_SIZE);
+    printf("%-12s %10s %10s %14s %16s\n", "path", "short cyc", "long cyc", "burst heap", "burst large free");
+
+    Run("copy", [](auto... args) { CopyPrint(args...); });
+    Run("cube_print", [](auto... args) { cube_print(args...); });
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+/**
+ ******************************************************************************
+ * File Name          : CubePrintFloodBench.cpp
+ * Description        : Print flood through the running Cube task. A producer
+ *    prints fixed length messages with CUBE_PRINT, the Cube task receives them
+ *    and transmits them on the (instant) host UART. Build once with the
+ *    default CUBE_TASK_RECEIVE_BATCH_SIZE (1, one Command per receive) and
+ *    once with -DCUBE_TASK_RECEIVE_BATCH_SIZE=8 for the batch receive (see
+ *    Benchmarks/README.md). Reports the
+ *    messages transmitted per second, the CPU time per message and the Cube
+ *    task wakeups per message.
+ ******************************************************************************
+*/
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include "BenchUtils.hpp"
+#include "CubeTask.hpp"
+
+/* Constants -----------------------------------------------------------------*/
+constexpr uint32_t NUM_MESSAGES = 200000;
+constexpr uint16_t BURST_SIZE = UART_TASK_QUEUE_DEPTH_OBJS;    // Prints per burst, fills the Cube task queue
+constexpr uint32_t MESSAGE_LENGTH = 14;                         // "Sensor 00000\r\n"
+
+/* Functions -----------------------------------------------------------------*/
+namespace
+{
+    void WaitQueueEmpty()
+    {
+        while (CubeTask::Inst().GetEventQueue()->GetQueueMessageCount() > 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    void WaitTransmitted(uint32_t bytes)
+    {
+        while (ulHostUartTxCount() < bytes) {
+            std::this_thread::yield();
+        }
+    }
+
+    double CpuSeconds()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    struct Result {
+        double rate;          // Messages transmitted per second
+        double cpuNs;         // CPU time of the producer and the Cube task per message transmitted
+        double wakeups;       // Cube task wakeups per message transmitted
+        uint32_t delivered;   // Messages transmitted
+    };
+
+    /**
+     * @brief Bursts that fill the queue, the next burst starts once the Cube task emptied it. No print is dropped.
+     */
+    Result RunBursts()
+    {
+        const uint32_t txStart = ulHostUartTxCount();
+        const uint32_t wakeupsStart = ulHostBlockedReceiveCount();
+        const double cpuStart = CpuSeconds();
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < NUM_MESSAGES; i += BURST_SIZE) {
+            for (uint16_t j = 0; j < BURST_SIZE; j++) {
+                CUBE_PRINT("Sensor %05u\r\n", static_cast<unsigned>((i + j) % 100000));
+            }
+            WaitQueueEmpty();
+        }
+        WaitTransmitted(txStart + NUM_MESSAGES * MESSAGE_LENGTH);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double cpuSeconds = CpuSeconds() - cpuStart;
+
+        const uint32_t wakeups = ulHostBlockedReceiveCount() - wakeupsStart;
+        return { NUM_MESSAGES / seconds, cpuSeconds * 1e9 / NUM_MESSAGES, static_cast<double>(wakeups) / NUM_MESSAGES, NUM_MESSAGES };
+    }
+
+    /**
+     * @brief Prints back to back, prints that find the queue full are dropped by CUBE_PRINT
+     */
+    Result RunFlood()
+    {
+        const uint32_t txStart = ulHostUartTxCount();
+        const uint32_t wakeupsStart = ulHostBlockedReceiveCount();
+        const double cpuStart = CpuSeconds();
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < NUM_MESSAGES; i++) {
+            CUBE_PRINT("Sensor %05u\r\n", static_cast<unsigned>(i % 100000));
+        }
+        WaitQueueEmpty();
+        const auto end = std::chrono::steady_clock::now();
+        const double cpuSeconds = CpuSeconds() - cpuStart;
+
+        // The last Commands may still be in transmission, wait until the UART goes quiet
+        uint32_t txCount;
+        do {
+            txCount = ulHostUartTxCount();
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        } while (ulHostUartTxCount() != txCount);
+
+        const uint32_t delivered = (txCount - txStart) / MESSAGE_LENGTH;
+        const uint32_t wakeups = ulHostBlockedReceiveCount() - wakeupsStart;
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        return { delivered / seconds, cpuSeconds * 1e9 / delivered, static_cast<double>(wakeups) / delivered, delivered };
+    }
+
+    template<typename RUN>
+    void Report(const char* name, RUN&& run)
+    {
+        Result best = {};
+        for (uint8_t i = 0; i < Bench::NUM_RUNS; i++) {
+            const Result result = run();
+            if (result.rate > best.rate) {
+                best = result;
+            }
+        }
+        printf("%-8s %10.1f %12.0f %14.3f %11.1f%%\n", name, best.rate / 1e3, best.cpuNs, best.wakeups,
+               100.0 * (NUM_MESSAGES - best.delivered) / NUM_MESSAGES);
+    }
+}
+
+int main()
+{
+    Bench::PrintHeader("CUBE_PRINT flood through the Cube task");
+    printf("CUBE_TASK_RECEIVE_BATCH_SIZE %d, queue depth %u, %lu messages of %lu B\n", CUBE_TASK_RECEIVE_BATCH_SIZE,
+           UART_TASK_QUEUE_DEPTH_OBJS, static_cast<unsigned long>(NUM_MESSAGES),
+           static_cast<unsigned long>(MESSAGE_LENGTH));
+
+    CubeTask::Inst().InitTask();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    printf("%-8s %10s %12s %14s %12s\n", "load", "kmsg/s", "CPU ns/msg", "wakeups/msg", "dropped");
+    Report("bursts", RunBursts);
+    Report("flood", RunFlood);
+
+    return 0;
+}
@@ -0,0 +1,167 @@
+/**
+ ******************************************************************************
+ * File Name          : EventDispatchLatencyBench.cpp
+ * Description        : Latency of an event on a second source of a task, with
+ *    the task polling its sources against waiting on them together with the
+ *    queue set dispatch (Task::DispatchEventWait). The task has its Command
+ *    event queue, which stays idle, and a TQueue of samples that another task
+ *    sends to. "poll" blocks on the event queue with a timeout and then checks
+ *    the sample queue without blocking, as a task without queue sets does.
+ *    Reports the time from the send to the handler and the task loop passes
+ *    per event.
+ ******************************************************************************
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "BenchUtils.hpp"
+#include "Core/Inc/Task.hpp"
+#include "Core/Inc/TQueue.hpp"
+
+/* Constants -----------------------------------------------------------------*/
+constexpr uint16_t NUM_SAMPLES = 400;
+constexpr uint32_t SEND_PERIOD_US = 2300;    // Minimum time between sends
+constexpr uint32_t SEND_JITTER_US = 10000;   // Spread added to the period, so sends land at every tick and poll phase
+constexpr uint16_t QUEUE_DEPTH = 8;
+
+/* Variables -----------------------------------------------------------------*/
+namespace
+{
+    std::atomic<uint32_t> sendStamp(0);            // Cycle count taken just before the send
+    std::atomic<uint16_t> numReceived(0);
+    std::atomic<bool> stop(false);
+    uint32_t latencies[NUM_SAMPLES];               // Cycles from the send to the handler
+    uint32_t numPasses;                            // Task loop passes of the current measurement
+}
+
+/* Class ---------------------------------------------------------------------*/
+namespace
+{
+    /**
+     * @brief Task with the event queue and a sample queue, runs its loop on the calling thread
+     */
+    class DispatchTask : public Task {
+    public:
+        DispatchTask() : Task(QUEUE_DEPTH), samples(QUEUE_DEPTH) {}
+
+        void InitTask() override {
+            AddEventSource(*qEvtQueue, HandleEvent, this);
+            AddEventSource(samples, HandleSample, this);
+            StartEventSet();
+        }
+
+        /**
+         * @brief Polling loop, blocks on the event queue for pollPeriod_ms then checks the sample queue
+         */
+        void RunPolling(uint32_t pollPeriod_ms) {
+            while (!stop) {
+                numPasses++;
+                Command cm;
+                if (qEvtQueue->Receive(cm, pollPeriod_ms)) {
+                    cm.Reset();
+                }
+                uint32_t sample;
+                if (samples.Receive(sample)) {
+                    Record();
+                }
+            }
+        }
+
+        /**
+         * @brief Queue set loop, one handler call per event
+         */
+        void RunDispatch() {
+            while (!stop) {
+                numPasses++;
+                DispatchEventWait();
+            }
+        }
+
+        TQueue<uint32_t>& GetSamples() { return samples; }
+
+    private:
+        static void HandleEvent(void* context, QueueSetMemberHandle_t) {
+            Command cm;
+            static_cast<DispatchTask*>(context)->qEvtQueue->Receive(cm);
+            cm.Reset();
+        }
+
+        static void HandleSample(void* context, QueueSetMemberHandle_t) {
+            uint32_t sample;
+            if (static_cast<DispatchTask*>(context)->samples.Receive(sample)) {
+                Record();
+            }
+        }
+
+        static void Record() {
+            const uint32_t latency = Bench::Cycles() - sendStamp.load();
+            if (numReceived < NUM_SAMPLES) {
+                latencies[numReceived] = latency;
+            }
+            numReceived++;
+        }
+
+        TQueue<uint32_t> samples;
+    };
+}
+
+/* Functions -----------------------------------------------------------------*/
+namespace
+{
+    /**
+     * @brief Runs one loop on a task thread while this thread sends NUM_SAMPLES samples
+     */
+    template<typename LOOP>
+    void Measure(const char* mode, DispatchTask& task, LOOP&& loop)
+    {
+        numReceived = 0;
+        numPasses = 0;
+        stop = false;
+        std::thread thread(loop);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+            uint32_t sample = i;
+            sendStamp = Bench::Cycles();
+            task.GetSamples().Send(sample);
+
+            // Wait for the task before the next sample, so every sample starts from a waiting task
+            while (numReceived <= i) {
+                std::this_thread::yield();
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(SEND_PERIOD_US + (i * 3700u) % SEND_JITTER_US));
+        }
+
+        // Wake the task with a Command so it sees the stop flag
+        stop = true;
+        Command cm(DATA_COMMAND, 0);
+        task.GetEventQueue()->Send(cm);
+        thread.join();
+
+        std::sort(latencies, latencies + NUM_SAMPLES);
+        printf("%-14s %10.1f %10.1f %10.1f %14.2f\n", mode,
+               Bench::CyclesToNs(latencies[NUM_SAMPLES / 2]) / 1000,
+               Bench::CyclesToNs(latencies[NUM_SAMPLES * 99 / 100]) / 1000,
+               Bench::CyclesToNs(latencies[NUM_SAMPLES - 1]) / 1000,
+               static_cast<double>(numPasses) / NUM_SAMPLES);
+    }
+}
+
+int main()
+{
+    Bench::PrintHeader("Event latency on a second task source, polling vs queue set dispatch");
+    printf("%u samples per loop, one every %lu-%lu us, 1 ms tick\n", NUM_SAMPLES, static_cast<unsigned long>(SEND_PERIOD_US),
+           static_cast<unsigned long>(SEND_PERIOD_US + SEND_JITTER_US));
+    printf("%-14s %10s %10s %10s %14s\n", "loop", "median us", "p99 us", "max us", "passes/event");
+
+    static DispatchTask pollTask;
+    Measure("poll 10 ms", pollTask, [] { pollTask.RunPolling(10); });
+    Measure("poll 1 ms", pollTask, [] { pollTask.RunPolling(1); });
+
+    static DispatchTask dispatchTask;
+    dispatchTask.InitTask();
+    Measure("queue set", dispatchTask, [] { dispatchTask.RunDispatch(); });
+
+    return 0;
+}
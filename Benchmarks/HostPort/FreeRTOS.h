@@ -0,0 +1,63 @@
+/**
+ ******************************************************************************
+ * File Name          : FreeRTOS.h
+ * Description        : Host port of the FreeRTOS types and configuration used by
+ *    Cube++, for building the benchmarks on a PC (see Benchmarks/README.md)
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_BENCHMARKS_HOST_FREERTOS_H
+#define CUBE_PLUSPLUS_BENCHMARKS_HOST_FREERTOS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+
+/* Configuration -------------------------------------------------------------*/
+#define configUSE_QUEUE_SETS 1
+#define configSUPPORT_STATIC_ALLOCATION 1
+#define configSUPPORT_DYNAMIC_ALLOCATION 1
+#define configTICK_RATE_HZ 1000
+#define tskKERNEL_VERSION_MAJOR 10
+#define tskKERNEL_VERSION_MINOR 3
+
+/* Types ---------------------------------------------------------------------*/
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define errQUEUE_FULL 0
+#define portMAX_DELAY 0xFFFFFFFFUL
+
+struct HostQueue;
+typedef HostQueue* QueueHandle_t;
+typedef HostQueue* SemaphoreHandle_t;
+typedef HostQueue* QueueSetHandle_t;
+typedef HostQueue* QueueSetMemberHandle_t;
+
+struct HostTask;
+typedef HostTask* TaskHandle_t;
+
+struct HostTimer;
+typedef HostTimer* TimerHandle_t;
+
+typedef void (*TaskFunction_t)(void*);
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t);
+
+// Static control blocks, the host port keeps its state on the heap so these are placeholders of the target sizes
+struct StaticQueue_t { uint8_t reserved[80]; };
+typedef StaticQueue_t StaticSemaphore_t;
+struct StaticTask_t { uint8_t reserved[96]; };
+struct StaticTimer_t { uint8_t reserved[44]; };
+
+void* pvPortMalloc(size_t size);
+void vPortFree(void* ptr);
+
+#include "task.h"
+#include "queue.h"
+
+#endif // CUBE_PLUSPLUS_BENCHMARKS_HOST_FREERTOS_H
@@ -0,0 +1,478 @@
+/**
+ ******************************************************************************
+ * File Name          : HostPort.cpp
+ * Description        : Host implementation of the FreeRTOS, HAL and LL subset used
+ *    by Cube++, for the benchmarks in Benchmarks/.
+ *
+ *    Kernel objects are ring buffers of fixed size items copied with memcpy,
+ *    the same work a target queue does, so relative costs are comparable.
+ *    Critical sections and scheduler suspension take one global recursive
+ *    kernel lock, tasks are host threads and blocking calls wait on a
+ *    condition variable of that lock.
+ *
+ *    Interrupt handlers are modelled with vHostEnterISR / vHostExitISR. A
+ *    task unblocked by a FromISR call is made ready but, as on a single core
+ *    target, only runs once the ISR requests a context switch with
+ *    portYIELD_FROM_ISR(pdTRUE) or at the next 1 ms tick.
+ ******************************************************************************
+*/
+#include "cmsis_os.h"
+#include "SystemDefines.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* Kernel State ------------------------------------------------------------------*/
+struct HostQueue {
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    uint8_t* storage;
+    UBaseType_t head;
+    UBaseType_t count;
+    HostQueue* set;             // Queue set this queue is a member of
+    uint32_t waiting;           // Tasks blocked on receive
+    bool isrPending;            // Last item arrived from an ISR that has not requested a switch yet
+    uint64_t isrEpoch;          // Switch epoch of the pending ISR item
+};
+
+struct HostTask {
+    const char* name;
+    uint32_t notifyValue;
+    bool waiting;
+    bool isrPending;
+    uint64_t isrEpoch;
+};
+
+struct HostTimer {
+    void* id;
+    TickType_t period;
+    UBaseType_t autoReload;
+};
+
+namespace {
+    // Never destroyed, task threads are still blocked on them while the process exits
+    std::recursive_mutex& kernelLock = *new std::recursive_mutex();
+    std::condition_variable_any& kernelCv = *new std::condition_variable_any();
+    uint64_t switchEpoch = 0;    // Incremented by every ISR context switch request and every tick
+    const auto startTime = std::chrono::steady_clock::now();
+    std::once_flag tickThreadOnce;
+
+    thread_local bool inIsr = false;
+    thread_local HostTask* currentTask = nullptr;
+
+    std::atomic<uint32_t> uartTxCount(0);
+    std::atomic<uint32_t> blockedReceiveCount(0);
+
+    std::chrono::steady_clock::time_point TickDeadline(TickType_t ticks) {
+        return std::chrono::steady_clock::now() + std::chrono::milliseconds(ticks);
+    }
+
+    /**
+     * @brief Tick interrupt, every tick releases the tasks readied by an ISR without a switch request
+     */
+    void StartTickThread() {
+        std::call_once(tickThreadOnce, [] {
+            std::thread([] {
+                auto next = std::chrono::steady_clock::now();
+                while (true) {
+                    next += std::chrono::milliseconds(1000 / configTICK_RATE_HZ);
+                    std::this_thread::sleep_until(next);
+                    std::lock_guard<std::recursive_mutex> lock(kernelLock);
+                    switchEpoch += 1;
+                    kernelCv.notify_all();
+                }
+            }).detach();
+        });
+    }
+
+    /**
+     * @brief A blocked task may run once its wake is not held back by a pending ISR switch
+     */
+    bool IsReleased(bool isrPending, uint64_t isrEpoch) {
+        return !isrPending || isrEpoch != switchEpoch;
+    }
+
+    /**
+     * @brief Wakes the tasks blocked on a queue after an item was added, wakes from an ISR are deferred
+     * @return pdTRUE if a blocked task was readied
+     */
+    BaseType_t SignalQueue(HostQueue* q) {
+        if (inIsr) {
+            q->isrPending = true;
+            q->isrEpoch = switchEpoch;
+            StartTickThread();
+        }
+        else {
+            q->isrPending = false;
+        }
+        kernelCv.notify_all();
+        return (q->waiting > 0) ? pdTRUE : pdFALSE;
+    }
+
+    HostQueue* CreateQueue(UBaseType_t length, UBaseType_t itemSize, UBaseType_t initialCount) {
+        HostQueue* q = new HostQueue();
+        q->length = length;
+        q->itemSize = itemSize;
+        q->storage = (itemSize > 0) ? static_cast<uint8_t*>(malloc(length * itemSize)) : nullptr;
+        q->count = initialCount;
+        return q;
+    }
+
+    BaseType_t Send(HostQueue* q, const void* item, TickType_t ticks, bool toFront, BaseType_t* woken);
+
+    /**
+     * @brief Copies an item into a queue with room for it and signals its receivers and queue set
+     */
+    BaseType_t Store(HostQueue* q, const void* item, bool toFront) {
+        UBaseType_t index;
+        if (toFront) {
+            q->head = (q->head + q->length - 1) % q->length;
+            index = q->head;
+        }
+        else {
+            index = (q->head + q->count) % q->length;
+        }
+        if (q->itemSize > 0) {
+            memcpy(q->storage + index * q->itemSize, item, q->itemSize);
+        }
+        q->count += 1;
+
+        BaseType_t woken = SignalQueue(q);
+        if (q->set != nullptr) {
+            BaseType_t setWoken = pdFALSE;
+            Send(q->set, &q, 0, false, &setWoken);
+            woken |= setWoken;
+        }
+        return woken;
+    }
+
+    BaseType_t Send(HostQueue* q, const void* item, TickType_t ticks, bool toFront, BaseType_t* woken) {
+        std::unique_lock<std::recursive_mutex> lock(kernelLock);
+        if (q->count == q->length) {
+            if (ticks == 0 || inIsr || !kernelCv.wait_until(lock, TickDeadline(ticks), [q] { return q->count < q->length; })) {
+                return errQUEUE_FULL;
+            }
+        }
+
+        const BaseType_t taskWoken = Store(q, item, toFront);
+        if (woken != nullptr && taskWoken) {
+            *woken = pdTRUE;
+        }
+        return pdPASS;
+    }
+
+    BaseType_t Receive(HostQueue* q, void* item, TickType_t ticks, bool peek) {
+        std::unique_lock<std::recursive_mutex> lock(kernelLock);
+        if (q->count == 0) {
+            if (ticks == 0 || inIsr) {
+                return pdFALSE;
+            }
+            q->waiting += 1;
+            const bool ready = kernelCv.wait_until(lock, TickDeadline(ticks), [q] {
+                return q->count > 0 && IsReleased(q->isrPending, q->isrEpoch);
+            });
+            q->waiting -= 1;
+            if (!ready) {
+                return pdFALSE;
+            }
+            blockedReceiveCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (q->itemSize > 0 && item != nullptr) {
+            memcpy(item, q->storage + q->head * q->itemSize, q->itemSize);
+        }
+        if (!peek) {
+            q->head = (q->head + 1) % q->length;
+            q->count -= 1;
+            kernelCv.notify_all();
+        }
+        return pdTRUE;
+    }
+
+    HostTask* CurrentTask() {
+        if (currentTask == nullptr) {
+            currentTask = new HostTask();
+            currentTask->name = "main";
+        }
+        return currentTask;
+    }
+
+    /**
+     * @brief Calibrates the host timestamp counter rate against the steady clock
+     */
+    uint32_t CalibrateCycleRate() {
+        const auto t0 = std::chrono::steady_clock::now();
+        const uint32_t c0 = ulHostCycleCount();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const uint32_t c1 = ulHostCycleCount();
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+        return static_cast<uint32_t>(static_cast<double>(c1 - c0) * 1e9 / static_cast<double>(ns));
+    }
+}
+
+/* Memory ------------------------------------------------------------------*/
+void* pvPortMalloc(size_t size) { return malloc(size); }
+void vPortFree(void* ptr) { free(ptr); }
+
+/* Task ------------------------------------------------------------------*/
+void vHostEnterCritical() { kernelLock.lock(); }
+void vHostExitCritical() { kernelLock.unlock(); }
+void vTaskSuspendAll() { kernelLock.lock(); }
+BaseType_t xTaskResumeAll() { kernelLock.unlock(); return pdFALSE; }
+
+void vHostYieldFromISR(BaseType_t xSwitchRequired) {
+    if (xSwitchRequired != pdFALSE) {
+        std::lock_guard<std::recursive_mutex> lock(kernelLock);
+        switchEpoch += 1;
+        kernelCv.notify_all();
+    }
+}
+
+void vHostEnterISR() { inIsr = true; }
+void vHostExitISR() { inIsr = false; }
+BaseType_t xPortIsInsideInterrupt() { return inIsr ? pdTRUE : pdFALSE; }
+
+TickType_t xTaskGetTickCount() {
+    return static_cast<TickType_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count() * configTICK_RATE_HZ / 1000);
+}
+TickType_t xTaskGetTickCountFromISR() { return xTaskGetTickCount(); }
+TaskHandle_t xTaskGetCurrentTaskHandle() { return CurrentTask(); }
+BaseType_t xTaskGetSchedulerState() { return taskSCHEDULER_RUNNING; }
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char* pcName, uint16_t, void* pvParameters, UBaseType_t,
+                       TaskHandle_t* pxCreatedTask) {
+    HostTask* task = new HostTask();
+    task->name = pcName;
+    if (pxCreatedTask != nullptr) {
+        *pxCreatedTask = task;
+    }
+    std::thread([=] {
+        currentTask = task;
+        pxTaskCode(pvParameters);
+    }).detach();
+    return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t pxTaskCode, const char* pcName, uint32_t ulStackDepth, void* pvParameters,
+                               UBaseType_t uxPriority, StackType_t*, StaticTask_t*) {
+    TaskHandle_t handle = nullptr;
+    xTaskCreate(pxTaskCode, pcName, static_cast<uint16_t>(ulStackDepth), pvParameters, uxPriority, &handle);
+    return handle;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify) {
+    std::lock_guard<std::recursive_mutex> lock(kernelLock);
+    xTaskToNotify->notifyValue += 1;
+    xTaskToNotify->isrPending = false;
+    kernelCv.notify_all();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t* pxHigherPriorityTaskWoken) {
+    std::lock_guard<std::recursive_mutex> lock(kernelLock);
+    xTaskToNotify->notifyValue += 1;
+    xTaskToNotify->isrPending = true;
+    xTaskToNotify->isrEpoch = switchEpoch;
+    StartTickThread();
+    kernelCv.notify_all();
+    if (pxHigherPriorityTaskWoken != nullptr && xTaskToNotify->waiting) {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+    HostTask* task = CurrentTask();
+    std::unique_lock<std::recursive_mutex> lock(kernelLock);
+    if (task->notifyValue == 0 && xTicksToWait > 0) {
+        task->waiting = true;
+        kernelCv.wait_until(lock, TickDeadline(xTicksToWait), [task] {
+            return task->notifyValue > 0 && IsReleased(task->isrPending, task->isrEpoch);
+        });
+        task->waiting = false;
+    }
+
+    const uint32_t value = task->notifyValue;
+    if (value > 0) {
+        task->notifyValue = (xClearCountOnExit != pdFALSE) ? 0 : value - 1;
+    }
+    return value;
+}
+
+char* pcTaskGetName(TaskHandle_t xTaskToQuery) {
+    return const_cast<char*>((xTaskToQuery != nullptr ? xTaskToQuery : CurrentTask())->name);
+}
+
+void vTaskDelay(TickType_t xTicksToDelay) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(xTicksToDelay * 1000 / configTICK_RATE_HZ));
+}
+
+/* Queue ------------------------------------------------------------------*/
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize) {
+    return CreateQueue(uxQueueLength, uxItemSize, 0);
+}
+QueueHandle_t xQueueCreateStatic(UBaseType_t uxQueueLength, UBaseType_t uxItemSize, uint8_t*, StaticQueue_t*) {
+    return CreateQueue(uxQueueLength, uxItemSize, 0);
+}
+void vQueueDelete(QueueHandle_t xQueue) {
+    free(xQueue->storage);
+    delete xQueue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait) {
+    return Send(xQueue, pvItemToQueue, xTicksToWait, false, nullptr);
+}
+BaseType_t xQueueSendToBack(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait) {
+    return Send(xQueue, pvItemToQueue, xTicksToWait, false, nullptr);
+}
+BaseType_t xQueueSendToFront(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait) {
+    return Send(xQueue, pvItemToQueue, xTicksToWait, true, nullptr);
+}
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void* pvItemToQueue, BaseType_t* pxHigherPriorityTaskWoken) {
+    return Send(xQueue, pvItemToQueue, 0, false, pxHigherPriorityTaskWoken);
+}
+BaseType_t xQueueSendToFrontFromISR(QueueHandle_t xQueue, const void* pvItemToQueue, BaseType_t* pxHigherPriorityTaskWoken) {
+    return Send(xQueue, pvItemToQueue, 0, true, pxHigherPriorityTaskWoken);
+}
+BaseType_t xQueueOverwrite(QueueHandle_t xQueue, const void* pvItemToQueue) {
+    std::lock_guard<std::recursive_mutex> lock(kernelLock);
+    xQueue->count = 0;
+    return Send(xQueue, pvItemToQueue, 0, false, nullptr);
+}
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void* pvBuffer, TickType_t xTicksToWait) {
+    return Receive(xQueue, pvBuffer, xTicksToWait, false);
+}
+BaseType_t xQueueReceiveFromISR(QueueHandle_t xQueue, void* pvBuffer, BaseType_t*) {
+    return Receive(xQueue, pvBuffer, 0, false);
+}
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void* pvBuffer, TickType_t xTicksToWait) {
+    return Receive(xQueue, pvBuffer, xTicksToWait, true);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue) {
+    std::lock_guard<std::recursive_mutex> lock(kernelLock);
+    return xQueue->count;
+}
+UBaseType_t uxQueueMessagesWaitingFromISR(QueueHandle_t xQueue) { return uxQueueMessagesWaiting(xQueue); }
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue) {
+    std::lock_guard<std::recursive_mutex> lock(kernelLock);
+    return xQueue->length - xQueue->count;
+}
+
+QueueSetHandle_t xQueueCreateSet(UBaseType_t uxEventQueueLength) {
+    return CreateQueue(uxEventQueueLength, sizeof(HostQueue*), 0);
+}
+BaseType_t xQueueAddToSet(QueueSetMemberHandle_t xQueueOrSemaphore, QueueSetHandle_t xQueueSet) {
+    std::lock_guard<std::recursive_mutex> lock(kernelLock);
+    if (xQueueOrSemaphore->set != nullptr || xQueueOrSemaphore->count > 0) {
+        return pdFAIL;
+    }
+    xQueueOrSemaphore->set = xQueueSet;
+    return pdPASS;
+}
+BaseType_t xQueueRemoveFromSet(QueueSetMemberHandle_t xQueueOrSemaphore, QueueSetHandle_t) {
+    std::lock_guard<std::recursive_mutex> lock(kernelLock);
+    xQueueOrSemaphore->set = nullptr;
+    return pdPASS;
+}
+QueueSetMemberHandle_t xQueueSelectFromSet(QueueSetHandle_t xQueueSet, TickType_t xTicksToWait) {
+    HostQueue* member = nullptr;
+    return (Receive(xQueueSet, &member, xTicksToWait, false) == pdTRUE) ? member : nullptr;
+}
+
+/* Semaphore ------------------------------------------------------------------*/
+SemaphoreHandle_t xSemaphoreCreateMutex() { return CreateQueue(1, 0, 1); }
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t*) { return CreateQueue(1, 0, 1); }
+SemaphoreHandle_t xSemaphoreCreateBinary() { return CreateQueue(1, 0, 0); }
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t*) { return CreateQueue(1, 0, 0); }
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount) {
+    return CreateQueue(uxMaxCount, 0, uxInitialCount);
+}
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount, StaticSemaphore_t*) {
+    return CreateQueue(uxMaxCount, 0, uxInitialCount);
+}
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore) { vQueueDelete(xSemaphore); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime) {
+    return Receive(xSemaphore, nullptr, xBlockTime, false);
+}
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore) {
+    return Send(xSemaphore, nullptr, 0, false, nullptr);
+}
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t xSemaphore, BaseType_t*) {
+    return Receive(xSemaphore, nullptr, 0, false);
+}
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore, BaseType_t* pxHigherPriorityTaskWoken) {
+    return Send(xSemaphore, nullptr, 0, false, pxHigherPriorityTaskWoken);
+}
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t xSemaphore) { return uxQueueMessagesWaiting(xSemaphore); }
+
+/* Timer ------------------------------------------------------------------*/
+TimerHandle_t xTimerCreate(const char*, TickType_t xTimerPeriod, UBaseType_t uxAutoReload, void* pvTimerID,
+                           TimerCallbackFunction_t) {
+    return new HostTimer{ pvTimerID, xTimerPeriod, uxAutoReload };
+}
+TimerHandle_t xTimerCreateStatic(const char* pcTimerName, TickType_t xTimerPeriod, UBaseType_t uxAutoReload,
+                                 void* pvTimerID, TimerCallbackFunction_t pxCallbackFunction, StaticTimer_t*) {
+    return xTimerCreate(pcTimerName, xTimerPeriod, uxAutoReload, pvTimerID, pxCallbackFunction);
+}
+BaseType_t xTimerDelete(TimerHandle_t xTimer, TickType_t) { delete xTimer; return pdPASS; }
+BaseType_t xTimerChangePeriod(TimerHandle_t xTimer, TickType_t xNewPeriod, TickType_t) { xTimer->period = xNewPeriod; return pdPASS; }
+BaseType_t xTimerStart(TimerHandle_t, TickType_t) { return pdPASS; }
+BaseType_t xTimerStop(TimerHandle_t, TickType_t) { return pdPASS; }
+void* pvTimerGetTimerID(TimerHandle_t xTimer) { return xTimer->id; }
+TickType_t xTimerGetPeriod(TimerHandle_t xTimer) { return xTimer->period; }
+TickType_t xTimerGetExpiryTime(TimerHandle_t xTimer) { return xTaskGetTickCount() + xTimer->period; }
+void vTimerSetReloadMode(TimerHandle_t xTimer, UBaseType_t uxAutoReload) { xTimer->autoReload = uxAutoReload; }
+UBaseType_t uxTimerGetReloadMode(TimerHandle_t xTimer) { return xTimer->autoReload; }
+
+/* HAL / LL ------------------------------------------------------------------*/
+uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef*, uint32_t*, uint32_t) { return 0; }
+void HAL_NVIC_SystemReset() {
+    fprintf(stderr, "HAL_NVIC_SystemReset\n");
+    abort();
+}
+
+void LL_USART_TransmitData8(USART_TypeDef*, uint8_t) { uartTxCount.fetch_add(1, std::memory_order_relaxed); }
+uint8_t LL_USART_ReceiveData8(USART_TypeDef*) { return 0; }
+bool LL_USART_IsActiveFlag_TXE(USART_TypeDef*) { return true; }
+bool LL_USART_IsActiveFlag_TC(USART_TypeDef*) { return true; }
+bool LL_USART_IsActiveFlag_RXNE(USART_TypeDef*) { return false; }
+bool LL_USART_IsActiveFlag_ORE(USART_TypeDef*) { return false; }
+bool LL_USART_IsActiveFlag_NE(USART_TypeDef*) { return false; }
+bool LL_USART_IsActiveFlag_FE(USART_TypeDef*) { return false; }
+bool LL_USART_IsActiveFlag_PE(USART_TypeDef*) { return false; }
+void LL_USART_ClearFlag_ORE(USART_TypeDef*) {}
+void LL_USART_EnableIT_RXNE(USART_TypeDef*) {}
+
+uint32_t ulHostUartTxCount() { return uartTxCount.load(std::memory_order_relaxed); }
+uint32_t ulHostBlockedReceiveCount() { return blockedReceiveCount.load(std::memory_order_relaxed); }
+
+uint32_t ulHostCycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+    return static_cast<uint32_t>(__rdtsc());
+#else
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+static DWT_Type dwt;
+DWT_Type* DWT = &dwt;
+static CoreDebug_Type coreDebug;
+CoreDebug_Type* CoreDebug = &coreDebug;
+uint32_t SystemCoreClock = CalibrateCycleRate();
+
+/* System Handles ------------------------------------------------------------------*/
+static USART_TypeDef usart5;
+UARTDriver Driver::uart5(&usart5);
+static CRC_HandleTypeDef crc;
+CRC_HandleTypeDef* SystemHandles::CRC_Handle = &crc;
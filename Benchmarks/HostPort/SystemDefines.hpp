@@ -0,0 +1,53 @@
+/**
+ ******************************************************************************
+ * File Name          : SystemDefines.hpp
+ * Description        : System defines of the host benchmark build, laid out like
+ *    the SystemDefines.hpp of a Cube++ project. Cube++ configuration macros
+ *    can be added here or passed with -D on the command line.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_BENCHMARKS_HOST_SYSTEM_DEFINES_H
+#define CUBE_PLUSPLUS_BENCHMARKS_HOST_SYSTEM_DEFINES_H
+
+/* Environment Defines ------------------------------------------------------------------*/
+#define COMPUTER_ENVIRONMENT
+
+/* System Wide Includes ------------------------------------------------------------------*/
+#include <new>
+#include "main.h"
+#include "cmsis_os.h"
+#include "Mutex.hpp"
+#include "CubeDefines.hpp"
+#include "UARTDriver.hpp"
+
+/* Global Commands ------------------------------------------------------------------*/
+enum GLOBAL_COMMANDS : uint8_t {
+    COMMAND_NONE = 0,
+    TASK_SPECIFIC_COMMAND,
+    DATA_COMMAND,
+    CONTROL_ACTION,
+};
+
+/* Task Parameter Definitions ------------------------------------------------------------------*/
+constexpr uint8_t UART_TASK_RTOS_PRIORITY = 2;
+constexpr uint8_t UART_TASK_QUEUE_DEPTH_OBJS = 10;
+constexpr uint16_t UART_TASK_STACK_DEPTH_WORDS = 512;
+
+/* System Handles ------------------------------------------------------------------*/
+class UARTDriver;
+
+namespace SystemHandles {
+    extern CRC_HandleTypeDef* CRC_Handle;
+}
+
+namespace Driver {
+    extern UARTDriver uart5;
+}
+
+namespace UART {
+    constexpr UARTDriver* Debug = &Driver::uart5;
+}
+
+constexpr UARTDriver* const DEFAULT_DEBUG_UART_DRIVER = UART::Debug;
+
+#endif // CUBE_PLUSPLUS_BENCHMARKS_HOST_SYSTEM_DEFINES_H
@@ -0,0 +1,19 @@
+/**
+ ******************************************************************************
+ * File Name          : cmsis_os.h
+ * Description        : Host port of the CMSIS-RTOS include used by Cube++
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_BENCHMARKS_HOST_CMSIS_OS_H
+#define CUBE_PLUSPLUS_BENCHMARKS_HOST_CMSIS_OS_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+#include "main.h"
+
+#define osKernelSysTickFrequency configTICK_RATE_HZ
+
+#endif // CUBE_PLUSPLUS_BENCHMARKS_HOST_CMSIS_OS_H
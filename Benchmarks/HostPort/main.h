@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ * File Name          : main.h
+ * Description        : Host port of the STM32 HAL / LL symbols used by Cube++.
+ *    The debug UART transmits into a discarded sink and the DWT cycle
+ *    counter reads the host timestamp counter.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_BENCHMARKS_HOST_MAIN_H
+#define CUBE_PLUSPLUS_BENCHMARKS_HOST_MAIN_H
+
+#include <cstdint>
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+struct USART_TypeDef { uint32_t reserved; };
+struct CRC_HandleTypeDef { uint32_t reserved; };
+
+uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef* hcrc, uint32_t* pBuffer, uint32_t BufferLength);
+void HAL_NVIC_SystemReset();
+
+void LL_USART_TransmitData8(USART_TypeDef* USARTx, uint8_t Value);
+uint8_t LL_USART_ReceiveData8(USART_TypeDef* USARTx);
+bool LL_USART_IsActiveFlag_TXE(USART_TypeDef* USARTx);
+bool LL_USART_IsActiveFlag_TC(USART_TypeDef* USARTx);
+bool LL_USART_IsActiveFlag_RXNE(USART_TypeDef* USARTx);
+bool LL_USART_IsActiveFlag_ORE(USART_TypeDef* USARTx);
+bool LL_USART_IsActiveFlag_NE(USART_TypeDef* USARTx);
+bool LL_USART_IsActiveFlag_FE(USART_TypeDef* USARTx);
+bool LL_USART_IsActiveFlag_PE(USART_TypeDef* USARTx);
+void LL_USART_ClearFlag_ORE(USART_TypeDef* USARTx);
+void LL_USART_EnableIT_RXNE(USART_TypeDef* USARTx);
+uint32_t ulHostUartTxCount();    // Host only, bytes written to any UART
+
+// DWT cycle counter, CYCCNT reads the host timestamp counter (truncated to 32 bits)
+uint32_t ulHostCycleCount();
+struct DWT_Type {
+    volatile uint32_t CTRL;
+    struct {
+        operator uint32_t() const { return ulHostCycleCount(); }
+    } CYCCNT;
+};
+extern DWT_Type* DWT;
+struct CoreDebug_Type { volatile uint32_t DEMCR; };
+extern CoreDebug_Type* CoreDebug;
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk (1UL)
+
+extern uint32_t SystemCoreClock;    // Host timestamp counter rate
+
+#endif // CUBE_PLUSPLUS_BENCHMARKS_HOST_MAIN_H
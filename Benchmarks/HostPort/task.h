@@ -0,0 +1,52 @@
+/**
+ ******************************************************************************
+ * File Name          : task.h
+ * Description        : Host port of the FreeRTOS task API. Critical sections and
+ *    scheduler suspension take one global kernel lock, tasks are host threads.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_BENCHMARKS_HOST_TASK_H
+#define CUBE_PLUSPLUS_BENCHMARKS_HOST_TASK_H
+
+#include "FreeRTOS.h"
+
+#define taskSCHEDULER_SUSPENDED 0
+#define taskSCHEDULER_NOT_STARTED 1
+#define taskSCHEDULER_RUNNING 2
+
+void vHostEnterCritical();
+void vHostExitCritical();
+void vHostYieldFromISR(BaseType_t xSwitchRequired);
+
+#define taskENTER_CRITICAL() vHostEnterCritical()
+#define taskEXIT_CRITICAL() vHostExitCritical()
+#define taskENTER_CRITICAL_FROM_ISR() (vHostEnterCritical(), (UBaseType_t)0)
+#define taskEXIT_CRITICAL_FROM_ISR(x) ((void)(x), vHostExitCritical())
+#define portYIELD_FROM_ISR(x) vHostYieldFromISR(x)
+#define portEND_SWITCHING_ISR(x) vHostYieldFromISR(x)
+#define portYIELD() ((void)0)
+#define taskYIELD() ((void)0)
+
+void vTaskSuspendAll();
+BaseType_t xTaskResumeAll();
+
+TickType_t xTaskGetTickCount();
+TickType_t xTaskGetTickCountFromISR();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+BaseType_t xTaskGetSchedulerState();
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char* pcName, uint16_t usStackDepth, void* pvParameters,
+                       UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask);
+TaskHandle_t xTaskCreateStatic(TaskFunction_t pxTaskCode, const char* pcName, uint32_t ulStackDepth, void* pvParameters,
+                               UBaseType_t uxPriority, StackType_t* puxStackBuffer, StaticTask_t* pxTaskBuffer);
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t* pxHigherPriorityTaskWoken);
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+char* pcTaskGetName(TaskHandle_t xTaskToQuery);
+void vTaskDelay(TickType_t xTicksToDelay);
+BaseType_t xPortIsInsideInterrupt();
+
+/* Host only -----------------------------------------------------------------*/
+void vHostEnterISR();    // Marks the calling thread as running an interrupt handler
+void vHostExitISR();
+
+#endif // CUBE_PLUSPLUS_BENCHMARKS_HOST_TASK_H
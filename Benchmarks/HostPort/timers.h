@@ -0,0 +1,27 @@
+/**
+ ******************************************************************************
+ * File Name          : timers.h
+ * Description        : Host port of the FreeRTOS software timer API, timers are
+ *    created and configured but never expire
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_BENCHMARKS_HOST_TIMERS_H
+#define CUBE_PLUSPLUS_BENCHMARKS_HOST_TIMERS_H
+
+#include "FreeRTOS.h"
+
+TimerHandle_t xTimerCreate(const char* pcTimerName, TickType_t xTimerPeriod, UBaseType_t uxAutoReload, void* pvTimerID,
+                           TimerCallbackFunction_t pxCallbackFunction);
+TimerHandle_t xTimerCreateStatic(const char* pcTimerName, TickType_t xTimerPeriod, UBaseType_t uxAutoReload,
+                                 void* pvTimerID, TimerCallbackFunction_t pxCallbackFunction, StaticTimer_t* pxTimerBuffer);
+BaseType_t xTimerDelete(TimerHandle_t xTimer, TickType_t xTicksToWait);
+BaseType_t xTimerChangePeriod(TimerHandle_t xTimer, TickType_t xNewPeriod, TickType_t xTicksToWait);
+BaseType_t xTimerStart(TimerHandle_t xTimer, TickType_t xTicksToWait);
+BaseType_t xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait);
+void* pvTimerGetTimerID(TimerHandle_t xTimer);
+TickType_t xTimerGetPeriod(TimerHandle_t xTimer);
+TickType_t xTimerGetExpiryTime(TimerHandle_t xTimer);
+void vTimerSetReloadMode(TimerHandle_t xTimer, UBaseType_t uxAutoReload);
+UBaseType_t uxTimerGetReloadMode(TimerHandle_t xTimer);
+
+#endif // CUBE_PLUSPLUS_BENCHMARKS_HOST_TIMERS_H
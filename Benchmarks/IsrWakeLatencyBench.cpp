@@ -0,0 +1,110 @@
+/**
+ ******************************************************************************
+ * File Name          : IsrWakeLatencyBench.cpp
+ * Description        : ISR to task wake latency. A simulated interrupt stamps
+ *    the cycle counter and sends one item to a task blocked on the queue, the
+ *    task measures the time from the stamp to its return from the receive.
+ *    "discarded" passes a woken flag to the FromISR send and never yields, as
+ *    the FromISR paths did before the flag was honoured, so the task runs at
+ *    the next tick. "yield" uses the default nullptr, the send requests the
+ *    context switch before the ISR returns.
+ ******************************************************************************
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "BenchUtils.hpp"
+#include "Core/Inc/Queue.hpp"
+#include "Core/Inc/TQueue.hpp"
+#include "Core/Inc/PQueue.hpp"
+#include "Core/Inc/SPSCQueue.hpp"
+
+/* Constants -----------------------------------------------------------------*/
+constexpr uint16_t NUM_SAMPLES = 400;
+constexpr uint32_t ISR_PERIOD_US = 2300;    // Not a multiple of the 1 ms tick, so interrupts land at every tick phase
+
+/* Variables -----------------------------------------------------------------*/
+namespace
+{
+    std::atomic<uint32_t> isrStamp(0);             // Cycle count taken by the ISR just before the send
+    std::atomic<uint16_t> numReceived(0);
+    uint32_t latencies[NUM_SAMPLES];               // Cycles from the ISR stamp to the task receive
+}
+
+/* Functions -----------------------------------------------------------------*/
+namespace
+{
+    /**
+     * @brief Runs one configuration, the calling thread is the interrupt and a second thread the receiving task
+     * @param send Called inside the ISR, sends one item
+     * @param receive Called by the task, blocks until an item is received
+     */
+    template<typename SEND, typename RECEIVE>
+    void Measure(const char* queueName, const char* mode, SEND&& send, RECEIVE&& receive)
+    {
+        numReceived = 0;
+        std::thread task([&] {
+            while (numReceived < NUM_SAMPLES) {
+                receive();
+                latencies[numReceived] = Bench::Cycles() - isrStamp.load();
+                numReceived++;
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+            vHostEnterISR();
+            isrStamp = Bench::Cycles();
+            send();
+            vHostExitISR();
+
+            // Wait for the task before the next interrupt, so every sample starts from a blocked task
+            while (numReceived <= i) {
+                std::this_thread::yield();
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(ISR_PERIOD_US));
+        }
+        task.join();
+
+        std::sort(latencies, latencies + NUM_SAMPLES);
+        printf("%-10s %-10s %10.1f %10.1f %10.1f\n", queueName, mode,
+               Bench::CyclesToNs(latencies[NUM_SAMPLES / 2]) / 1000,
+               Bench::CyclesToNs(latencies[NUM_SAMPLES * 99 / 100]) / 1000,
+               Bench::CyclesToNs(latencies[NUM_SAMPLES - 1]) / 1000);
+    }
+}
+
+int main()
+{
+    Bench::PrintHeader("ISR to task wake latency");
+    printf("%u interrupts per configuration, 1 ms tick\n", NUM_SAMPLES);
+    printf("%-10s %-10s %10s %10s %10s\n", "queue", "woken flag", "median us", "p99 us", "max us");
+
+    static Queue queue(8);
+    static TQueue<uint32_t> tqueue(8);
+    static PQueue<uint32_t, 8> pqueue;
+    static SPSCQueue<uint32_t, 8> spsc;
+    uint32_t item = 0;
+
+    for (const bool yield : { false, true }) {
+        const char* mode = yield ? "yield" : "discarded";
+        BaseType_t discarded = pdFALSE;
+        BaseType_t* woken = yield ? nullptr : &discarded;
+
+        Measure("Queue", mode,
+                [&] { Command cm(DATA_COMMAND, 1); queue.SendFromISR(cm, woken); },
+                [&] { Command cm; queue.ReceiveWait(cm); cm.Reset(); });
+        Measure("TQueue", mode,
+                [&] { tqueue.SendFromISR(item, woken); },
+                [&] { uint32_t received; tqueue.ReceiveWait(received); });
+        Measure("PQueue", mode,
+                [&] { pqueue.SendFromISR(item, Priority::NORMAL, woken); },
+                [&] { uint32_t received; pqueue.ReceiveWait(received); });
+        Measure("SPSCQueue", mode,
+                [&] { spsc.SendFromISR(item, woken); },
+                [&] { uint32_t received; spsc.ReceiveWait(received); });
+    }
+
+    return 0;
+}
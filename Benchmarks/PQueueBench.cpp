@@ -0,0 +1,100 @@
+/**
+ ******************************************************************************
+ * File Name          : PQueueBench.cpp
+ * Description        : PQueue Send / Receive cost of a 16 B item, with the
+ *    queue otherwise empty and with 8 items already queued at mixed
+ *    priorities. Only uses the PQueue<T, SIZE> interface that predates the
+ *    ordering policies, so the same source can be built against an older tree
+ *    with -DPQUEUE_BENCH_BASELINE (see Benchmarks/README.md). The current
+ *    tree also measures SendFromISR from a simulated interrupt.
+ ******************************************************************************
+*/
+#include "BenchUtils.hpp"
+#include "Core/Inc/PQueue.hpp"
+
+/* Constants -----------------------------------------------------------------*/
+constexpr uint32_t NUM_ITEMS = 200000;
+constexpr uint16_t NUM_QUEUED = 8;
+
+/* Structs -----------------------------------------------------------------*/
+struct Item {
+    uint32_t words[4];
+};
+
+/* Functions -----------------------------------------------------------------*/
+namespace
+{
+    /**
+     * @brief Send and Receive cycles per item, each timed on its own, fastest of Bench::NUM_RUNS runs
+     */
+    template<typename Q, typename SEND>
+    void Measure(Q& queue, uint16_t numQueued, SEND&& send, double& sendCycles, double& receiveCycles)
+    {
+        Item item = {};
+        Item received;
+        for (uint16_t i = 0; i < numQueued; i++) {
+            queue.Send(item, static_cast<uint8_t>(i * 20));
+        }
+
+        for (uint8_t run = 0; run < Bench::NUM_RUNS; run++) {
+            uint64_t sendTotal = 0;
+            uint64_t receiveTotal = 0;
+            for (uint32_t i = 0; i < NUM_ITEMS; i++) {
+                const uint8_t priority = (numQueued == 0) ? static_cast<uint8_t>((i % 3) * 50 + 50)
+                                                          : static_cast<uint8_t>((i * 37) % 200);
+                const uint32_t start = Bench::Cycles();
+                send(item, priority);
+                const uint32_t sent = Bench::Cycles();
+                queue.Receive(received);
+                receiveTotal += Bench::Cycles() - sent;
+                sendTotal += sent - start;
+            }
+
+            const double sendPerItem = static_cast<double>(sendTotal) / NUM_ITEMS;
+            const double receivePerItem = static_cast<double>(receiveTotal) / NUM_ITEMS;
+            if (run == 0 || sendPerItem < sendCycles) {
+                sendCycles = sendPerItem;
+            }
+            if (run == 0 || receivePerItem < receiveCycles) {
+                receiveCycles = receivePerItem;
+            }
+        }
+
+        while (queue.Receive(received)) {}
+    }
+
+    template<typename Q, typename SEND>
+    void Run(const char* name, Q& queue, SEND&& send)
+    {
+        double emptySend = 0, emptyReceive = 0, queuedSend = 0, queuedReceive = 0;
+        Measure(queue, 0, send, emptySend, emptyReceive);
+        Measure(queue, NUM_QUEUED, send, queuedSend, queuedReceive);
+
+        printf("%-16s %10.1f %10.1f %10.1f %10.1f\n", name, emptySend, emptyReceive, queuedSend, queuedReceive);
+    }
+}
+
+int main()
+{
+    Bench::PrintHeader("PQueue Send / Receive, 16 B item");
+    printf("%-16s %10s %10s %10s %10s\n", "", "empty", "", "8 queued", "");
+    printf("%-16s %10s %10s %10s %10s\n", "queue", "send cyc", "recv cyc", "send cyc", "recv cyc");
+
+    static PQueue<Item, 16> heapQueue;
+    Run("PQueue", heapQueue, [&](const Item& item, uint8_t priority) { heapQueue.Send(item, priority); });
+
+#ifndef PQUEUE_BENCH_BASELINE
+    static PQueue<Item, 16, PQueueBucketOrder> bucketQueue;
+    Run("PQueue buckets", bucketQueue, [&](const Item& item, uint8_t priority) { bucketQueue.Send(item, priority); });
+
+    // SendFromISR in a simulated interrupt, the woken flag is collected for one yield at the end of the ISR
+    Run("PQueue ISR", heapQueue, [&](const Item& item, uint8_t priority) {
+        vHostEnterISR();
+        BaseType_t woken = pdFALSE;
+        heapQueue.SendFromISR(item, priority, &woken);
+        vHostExitISR();
+    });
+#endif
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+/**
+ ******************************************************************************
+ * File Name          : PoolQueueBench.cpp
+ * Description        : PoolQueue (objects in an ObjectPool, pointers queued)
+ *    against TQueue (objects copied into and out of the RTOS queue) for
+ *    several object sizes. Reports the RAM of each setup, the bytes copied
+ *    through the RTOS queue and the cycles per object for acquire / fill /
+ *    send / receive / release on one thread. The producer writes the first
+ *    and last word of the object, so the copies TQueue makes show in the
+ *    result.
+ ******************************************************************************
+*/
+#include "BenchUtils.hpp"
+#include "Core/Inc/TQueue.hpp"
+#include "Core/Inc/ObjectPool.hpp"
+#include "Core/Inc/PoolQueue.hpp"
+
+/* Constants -----------------------------------------------------------------*/
+constexpr uint16_t QUEUE_DEPTH = 8;
+constexpr uint16_t POOL_SIZE = QUEUE_DEPTH + 2;    // A full queue, plus the object being filled and the one being processed
+constexpr uint32_t NUM_OBJECTS = 200000;
+
+/* Structs -----------------------------------------------------------------*/
+template<size_t SIZE>
+struct Frame {
+    uint32_t words[SIZE / sizeof(uint32_t)];
+};
+
+/* Functions -----------------------------------------------------------------*/
+namespace
+{
+    volatile uint32_t sink;
+
+    template<size_t SIZE>
+    void Run()
+    {
+        typedef Frame<SIZE> T;
+
+        static TQueue<T> tqueue(QUEUE_DEPTH);
+        static ObjectPool<T, POOL_SIZE> pool;
+        static PoolQueue<T> poolQueue(pool, QUEUE_DEPTH);
+
+        const double tqueueCycles = Bench::MeasureCycles(NUM_OBJECTS, [&](uint32_t i) {
+            T frame;
+            frame.words[0] = i;
+            frame.words[SIZE / sizeof(uint32_t) - 1] = i;
+            tqueue.Send(frame);
+
+            T received;
+            tqueue.Receive(received);
+            sink = received.words[0] + received.words[SIZE / sizeof(uint32_t) - 1];
+        });
+
+        const double poolCycles = Bench::MeasureCycles(NUM_OBJECTS, [&](uint32_t i) {
+            PoolPtr<T> frame = pool.Acquire();
+            frame->words[0] = i;
+            frame->words[SIZE / sizeof(uint32_t) - 1] = i;
+            poolQueue.Send(std::move(frame));
+
+            PoolPtr<T> received;
+            poolQueue.Receive(received);
+            sink = received->words[0] + received->words[SIZE / sizeof(uint32_t) - 1];
+        });
+
+        // TQueue needs the queue storage and a copy on the producer and the consumer stack, PoolQueue the pool
+        // (which holds those two objects) and a queue of pointers
+        const size_t tqueueRam = (QUEUE_DEPTH + 2) * sizeof(T);
+        const size_t poolRam = sizeof(pool) + QUEUE_DEPTH * sizeof(T*);
+
+        printf("%6u B %12u B %12u B %10u B %10u B %12.1f %12.1f\n", static_cast<unsigned>(SIZE),
+               static_cast<unsigned>(tqueueRam), static_cast<unsigned>(poolRam), static_cast<unsigned>(2 * sizeof(T)),
+               static_cast<unsigned>(2 * sizeof(T*)), tqueueCycles, poolCycles);
+    }
+}
+
+int main()
+{
+    Bench::PrintHeader("PoolQueue vs TQueue");
+    printf("queue depth %u, pool of %u objects\n", QUEUE_DEPTH, POOL_SIZE);
+    printf("%8s %14s %14s %12s %12s %12s %12s\n", "object", "TQueue RAM", "PoolQueue RAM", "TQueue copy", "PoolQ copy",
+           "TQueue cyc", "PoolQ cyc");
+
+    Run<16>();
+    Run<64>();
+    Run<256>();
+    Run<1024>();
+
+    return 0;
+}
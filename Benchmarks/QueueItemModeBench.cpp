@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ * File Name          : QueueItemModeBench.cpp
+ * Description        : Queue in QUEUE_ITEM_COMMAND mode (full Commands copied
+ *    through the RTOS queue) against QUEUE_ITEM_HANDLE mode (Commands parked
+ *    in the CommandSlotTable, 32-bit handles queued). Reports the queue RAM
+ *    of both modes, the shared slot table RAM and the Send / Receive cycles
+ *    per Command, each timed on its own. Handle mode adds a slot table Store
+ *    on every send and a Take on every receive, each in a critical section.
+ ******************************************************************************
+*/
+#include "BenchUtils.hpp"
+#include "Core/Inc/Queue.hpp"
+
+/* Constants -----------------------------------------------------------------*/
+constexpr uint32_t NUM_COMMANDS = 200000;
+constexpr uint16_t NUM_QUEUED = 4;
+
+/* Functions -----------------------------------------------------------------*/
+namespace
+{
+    /**
+     * @brief Send and Receive cycles per Command, each timed on its own, fastest of Bench::NUM_RUNS runs
+     */
+    void Measure(Queue& queue, uint16_t numQueued, double& sendCycles, double& receiveCycles)
+    {
+        for (uint16_t i = 0; i < numQueued; i++) {
+            Command cm(DATA_COMMAND, i);
+            queue.Send(cm);
+        }
+
+        for (uint8_t run = 0; run < Bench::NUM_RUNS; run++) {
+            uint64_t sendTotal = 0;
+            uint64_t receiveTotal = 0;
+            for (uint32_t i = 0; i < NUM_COMMANDS; i++) {
+                Command cm(DATA_COMMAND, static_cast<uint16_t>(i));
+                Command received;
+                const uint32_t start = Bench::Cycles();
+                queue.Send(cm);
+                const uint32_t sent = Bench::Cycles();
+                queue.Receive(received);
+                receiveTotal += Bench::Cycles() - sent;
+                sendTotal += sent - start;
+            }
+
+            const double sendPerCommand = static_cast<double>(sendTotal) / NUM_COMMANDS;
+            const double receivePerCommand = static_cast<double>(receiveTotal) / NUM_COMMANDS;
+            if (run == 0 || sendPerCommand < sendCycles) {
+                sendCycles = sendPerCommand;
+            }
+            if (run == 0 || receivePerCommand < receiveCycles) {
+                receiveCycles = receivePerCommand;
+            }
+        }
+
+        Command cm;
+        while (queue.Receive(cm)) {
+            cm.Reset();
+        }
+    }
+
+    void Run(const char* name, QueueItemMode itemMode)
+    {
+        Queue queue(DEFAULT_QUEUE_SIZE, itemMode);
+
+        double emptySend = 0, emptyReceive = 0, queuedSend = 0, queuedReceive = 0;
+        Measure(queue, 0, emptySend, emptyReceive);
+        Measure(queue, NUM_QUEUED, queuedSend, queuedReceive);
+
+        printf("%-8s %10u B %10.1f %10.1f %10.1f %10.1f\n", name,
+               static_cast<unsigned>(DEFAULT_QUEUE_SIZE * GetQueueItemSize(itemMode)),
+               emptySend, emptyReceive, queuedSend, queuedReceive);
+    }
+}
+
+int main()
+{
+    Bench::PrintHeader("Queue item mode, Command vs handle");
+
+    // Slot table: a parked Command, a generation and a free stack entry per slot
+    const size_t slotRam = sizeof(Command) + 2 * sizeof(uint16_t);
+    printf("sizeof(Command) %u B, queue depth %u, slot table %u slots x %u B = %u B shared by every handle mode queue\n",
+           static_cast<unsigned>(sizeof(Command)), static_cast<unsigned>(DEFAULT_QUEUE_SIZE),
+           static_cast<unsigned>(COMMAND_SLOT_TABLE_SIZE), static_cast<unsigned>(slotRam),
+           static_cast<unsigned>(COMMAND_SLOT_TABLE_SIZE * slotRam));
+
+    printf("%-8s %12s %10s %10s %10s %10s\n", "", "", "empty", "", "4 queued", "");
+    printf("%-8s %12s %10s %10s %10s %10s\n", "mode", "queue RAM", "send cyc", "recv cyc", "send cyc", "recv cyc");
+    Run("Command", QUEUE_ITEM_COMMAND);
+    Run("handle", QUEUE_ITEM_HANDLE);
+
+    return 0;
+}
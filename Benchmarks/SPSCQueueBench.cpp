@@ -0,0 +1,152 @@
+/**
+ ******************************************************************************
+ * File Name          : SPSCQueueBench.cpp
+ * Description        : SPSCQueue against TQueue for an ISR producer feeding one
+ *    task. Reports the cycles per item spent in the ISR and in the consumer
+ *    (single thread, the ISR fills the queue then the task drains it) and the
+ *    items per second with the ISR and the consumer task on separate threads.
+ ******************************************************************************
+*/
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "BenchUtils.hpp"
+#include "Core/Inc/SPSCQueue.hpp"
+#include "Core/Inc/TQueue.hpp"
+
+/* Constants -----------------------------------------------------------------*/
+constexpr uint16_t QUEUE_DEPTH = 64;
+constexpr uint32_t NUM_ROUNDS = 4000;          // Fill / drain rounds of the cycle measurement
+constexpr uint32_t NUM_ITEMS = 1000000;        // Items of the throughput measurement
+constexpr uint16_t ISR_BURST = 16;             // Items sent per simulated interrupt
+
+/* Structs -----------------------------------------------------------------*/
+struct Sample {
+    uint32_t timestamp;
+    int16_t values[6];
+};
+
+/* Functions -----------------------------------------------------------------*/
+namespace
+{
+    template<typename Q>
+    struct Consumer {
+        Q* queue;
+        std::atomic<uint32_t> received;
+    };
+
+    template<typename Q, typename T>
+    void ConsumerTask(void* pvParams)
+    {
+        Consumer<Q>* consumer = static_cast<Consumer<Q>*>(pvParams);
+        T item;
+        while (true) {
+            if (consumer->queue->ReceiveWait(item)) {
+                consumer->received.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief ISR and task cycles per item. The ISR fills the queue without requesting a switch, then the task
+     *        drains it, each side is timed on its own and the fastest of Bench::NUM_RUNS runs is kept.
+     */
+    template<typename Q, typename T>
+    void MeasureCycles(Q& queue, double& isrCycles, double& taskCycles)
+    {
+        T item = {};
+
+        // Block once so the consumer is registered and the ISR pays for the notification
+        queue.Receive(item, 1);
+
+        for (uint8_t run = 0; run < Bench::NUM_RUNS; run++) {
+            uint64_t isrTotal = 0;
+            uint64_t taskTotal = 0;
+            for (uint32_t round = 0; round < NUM_ROUNDS; round++) {
+                vHostEnterISR();
+                BaseType_t woken = pdFALSE;
+                const uint32_t isrStart = Bench::Cycles();
+                for (uint16_t i = 0; i < QUEUE_DEPTH; i++) {
+                    queue.SendFromISR(item, &woken);
+                }
+                isrTotal += Bench::Cycles() - isrStart;
+                vHostExitISR();
+
+                const uint32_t taskStart = Bench::Cycles();
+                for (uint16_t i = 0; i < QUEUE_DEPTH; i++) {
+                    queue.Receive(item);
+                }
+                taskTotal += Bench::Cycles() - taskStart;
+            }
+
+            const double isrPerItem = static_cast<double>(isrTotal) / (NUM_ROUNDS * QUEUE_DEPTH);
+            const double taskPerItem = static_cast<double>(taskTotal) / (NUM_ROUNDS * QUEUE_DEPTH);
+            if (run == 0 || isrPerItem < isrCycles) {
+                isrCycles = isrPerItem;
+            }
+            if (run == 0 || taskPerItem < taskCycles) {
+                taskCycles = taskPerItem;
+            }
+        }
+    }
+
+    /**
+     * @brief Items per second, ISR bursts on this thread and a consumer task blocked in ReceiveWait
+     */
+    template<typename Q, typename T>
+    double MeasureThroughput(Q& queue)
+    {
+        Consumer<Q> consumer = { &queue, {0} };
+        TaskHandle_t handle;
+        xTaskCreate(ConsumerTask<Q, T>, "Consumer", 256, &consumer, 2, &handle);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        T item = {};
+        const auto start = std::chrono::steady_clock::now();
+        uint32_t sent = 0;
+        while (sent < NUM_ITEMS) {
+            vHostEnterISR();
+            for (uint16_t i = 0; i < ISR_BURST && sent < NUM_ITEMS; i++) {
+                if (!queue.SendFromISR(item)) {
+                    break;
+                }
+                sent++;
+            }
+            vHostExitISR();
+            std::this_thread::yield();
+        }
+        while (consumer.received.load(std::memory_order_relaxed) < NUM_ITEMS) {
+            std::this_thread::yield();
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return NUM_ITEMS / seconds;
+    }
+
+    template<typename T>
+    void Run(const char* itemName)
+    {
+        static SPSCQueue<T, QUEUE_DEPTH> spsc;
+        static TQueue<T> tqueue(QUEUE_DEPTH);
+
+        double spscIsr = 0, spscTask = 0, tqueueIsr = 0, tqueueTask = 0;
+        MeasureCycles<SPSCQueue<T, QUEUE_DEPTH>, T>(spsc, spscIsr, spscTask);
+        MeasureCycles<TQueue<T>, T>(tqueue, tqueueIsr, tqueueTask);
+
+        const double spscRate = MeasureThroughput<SPSCQueue<T, QUEUE_DEPTH>, T>(spsc);
+        const double tqueueRate = MeasureThroughput<TQueue<T>, T>(tqueue);
+
+        printf("%-10s %-10s %12.1f %12.1f %14.2f\n", itemName, "SPSCQueue", spscIsr, spscTask, spscRate / 1e6);
+        printf("%-10s %-10s %12.1f %12.1f %14.2f\n", itemName, "TQueue", tqueueIsr, tqueueTask, tqueueRate / 1e6);
+    }
+}
+
+int main()
+{
+    Bench::PrintHeader("SPSCQueue vs TQueue, ISR producer");
+    printf("%-10s %-10s %12s %12s %14s\n", "item", "queue", "ISR cyc/item", "task cyc/item", "Mitems/s");
+
+    Run<uint8_t>("uint8_t");
+    Run<Sample>("16 B");
+
+    return 0;
+}
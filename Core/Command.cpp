@@ -12,11 +12,59 @@
  ******************************************************************************
 */
 #include "Core/Inc/Command.hpp"
+#include "Core/Inc/CommandPool.hpp"
 
 #include "CubeDefines.hpp"
 #include "SystemDefines.hpp"
 
 #include <cstring>     // Support for memcpy
+#include <new>         // Support for placement new
+
+/* Structs ------------------------------------------------------------------*/
+namespace {
+    /**
+     * @brief Header placed in front of every shared data block, the payload follows it. Padded to the pool block
+     *        alignment so the payload keeps the same alignment as an unshared block.
+    */
+    struct alignas(COMMAND_POOL_BLOCK_ALIGNMENT) CommandSharedHeader {
+        std::atomic<uint16_t> refCount;    // Number of Commands referencing the block
+    };
+
+    inline CommandSharedHeader* GetSharedHeader(uint8_t* sharedData) {
+        return reinterpret_cast<CommandSharedHeader*>(sharedData) - 1;
+    }
+
+    // Largest payload of a shared block, the block with its header must still fit a uint16_t allocation size
+    constexpr uint16_t COMMAND_MAX_SHARED_DATA_SIZE = UINT16_MAX - sizeof(CommandSharedHeader);
+
+    /**
+     * @brief Segment list of a scatter-gather payload, allocated from the CommandPool and referenced by the data pointer
+    */
+    struct CommandSegmentList {
+        struct {
+            uint8_t* data;     // Segment data
+            uint16_t size;     // Segment size in bytes
+            bool owned;        // Segment was allocated from the CommandPool and is freed with the Command
+        } segments[COMMAND_MAX_SEGMENTS];
+        uint8_t count;         // Number of segments in use
+    };
+
+    inline CommandSegmentList* GetSegmentList(uint8_t* segmentedData) {
+        return reinterpret_cast<CommandSegmentList*>(segmentedData);
+    }
+
+    /**
+     * @brief Frees the owned segments of a segment list, and the list itself
+    */
+    void FreeSegmentList(CommandSegmentList* list) {
+        for (uint8_t i = 0; i < list->count; i++) {
+            if (list->segments[i].owned) {
+                CommandPool::Free(list->segments[i].data);
+            }
+        }
+        CommandPool::Free(reinterpret_cast<uint8_t*>(list));
+    }
+}
 
 /* Static Variable Init ------------------------------------------------------------------*/
 std::atomic<uint16_t> Command::statAllocationCounter; // Static variable init
@@ -34,7 +82,7 @@ Command::Command(void)
     taskCommand = 0;
     data = nullptr;
     dataSize = 0;
-    bShouldFreeData = false;
+    dataMode = COMMAND_DATA_NONE;
 }
 
 /**
@@ -47,7 +95,7 @@ Command::Command(GLOBAL_COMMANDS command)
     taskCommand = 0;
     data = nullptr;
     dataSize = 0;
-    bShouldFreeData = false;
+    dataMode = COMMAND_DATA_NONE;
 }
 
 /**
@@ -60,7 +108,7 @@ Command::Command(uint16_t taskCommand)
     this->taskCommand = taskCommand;
     data = nullptr;
     dataSize = 0;
-    bShouldFreeData = false;
+    dataMode = COMMAND_DATA_NONE;
 }
 
 /**
@@ -74,7 +122,7 @@ Command::Command(GLOBAL_COMMANDS command, uint16_t taskCommand)
     this->taskCommand = taskCommand;
     data = nullptr;
     dataSize = 0;
-    bShouldFreeData = false;
+    dataMode = COMMAND_DATA_NONE;
 }
 
 // We cannot use a Destructor, it would get destroyed at lifetime end
@@ -86,24 +134,15 @@ Command::Command(GLOBAL_COMMANDS command, uint16_t taskCommand)
 //}
 
 /**
- * @brief Dynamically allocates memory for the command with the given data size
+ * @brief Allocates memory for the command with the given data size. Payloads up to COMMAND_INLINE_DATA_SIZE
+ *        are stored inline in the Command, larger payloads are served by the CommandPool (heap fallback for
+ *        oversize payloads, not in an ISR). Inline data lives inside this object, so it must be filled in before sending.
  * @param dataSize Size of array to allocate
- * @return Pointer to data on success, nullptr on failure (mem already allocated)
+ * @return Pointer to data on success, nullptr on failure (mem already allocated, or pool exhausted in an ISR)
 */
 uint8_t* Command::AllocateData(uint16_t dataSize)
 {
-    // If we don't have anything allocated, allocate and return success
-    if (this->data == nullptr && !bShouldFreeData) {
-        this->data = cube_malloc(dataSize);
-        this->bShouldFreeData = true;
-        this->dataSize = dataSize;
-        statAllocationCounter += 1;
-
-        //TODO: May want to print out whenever we have an imbalance in statAllocationCounter by more than ~5 or so.
-        CUBE_ASSERT(statAllocationCounter < MAX_NUMBER_OF_COMMAND_ALLOCATIONS);
-        return this->data;
-    }
-    return nullptr;
+    return AllocateDataInternal(dataSize, false, COMMAND_CALL_SITE());
 }
 
 /**
@@ -118,9 +157,9 @@ uint8_t* Command::AllocateData(uint16_t dataSize)
 bool Command::SetCommandToStaticExternalBuffer(uint8_t* existingPtr, uint16_t size)
 {
     // If we don't have anything allocated, set it and return success
-    if(this->data == nullptr) {
+    if(!HasData()) {
         this->data = existingPtr;
-        this->bShouldFreeData = false;
+        this->dataMode = COMMAND_DATA_EXTERNAL;
         this->dataSize = size;
         return true;
     }
@@ -133,25 +172,350 @@ bool Command::SetCommandToStaticExternalBuffer(uint8_t* existingPtr, uint16_t si
 bool Command::CopyDataToCommand(uint8_t* dataSrc, uint16_t size)
 {
     // If we successfully allocate, copy the data and return success
-    if(this->AllocateData(size)
-        && this->data != nullptr) {
-        memcpy(this->data, dataSrc, size);
+    uint8_t* dest = this->AllocateDataInternal(size, false, COMMAND_CALL_SITE());
+    if(dest != nullptr) {
+        memcpy(dest, dataSrc, size);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Allocates a reference counted data block for the command, the block can then be referenced by other
+ *        Commands with ShareDataWith() and is freed when the last Command referencing it is reset
+ * @param dataSize Size of array to allocate
+ * @return Pointer to data on success, nullptr on failure (mem already allocated, or pool exhausted in an ISR)
+*/
+uint8_t* Command::AllocateSharedData(uint16_t dataSize)
+{
+    return AllocateDataInternal(dataSize, true, COMMAND_CALL_SITE());
+}
+
+/**
+ * @brief Copies data from the source array into a newly allocated reference counted block owned by Command
+ */
+bool Command::CopyDataToSharedCommand(uint8_t* dataSrc, uint16_t size)
+{
+    uint8_t* dest = this->AllocateDataInternal(size, true, COMMAND_CALL_SITE());
+    if(dest != nullptr) {
+        memcpy(dest, dataSrc, size);
         return true;
     }
 
     return false;
 }
 
+/**
+ * @brief Makes the target Command reference the data of this Command without copying the payload. Shared blocks
+ *        gain a reference, external buffers are referenced directly and inline data is copied by value.
+ *        Exclusively allocated data (AllocateData) cannot be shared, use AllocateSharedData or MakeShared() first.
+ *        Safe to call from an ISR, it never allocates. AllocateSharedData and MakeShared can fail in an ISR when
+ *        the CommandPool cannot serve the block, as there is no heap fallback there.
+ * @param target Command to share the data with, must not hold any data
+ * @return TRUE on success, FALSE if the target already holds data or the data cannot be shared
+*/
+bool Command::ShareDataWith(Command& target) const
+{
+    if (target.HasData()) {
+        return false;
+    }
+
+    switch (dataMode) {
+    case COMMAND_DATA_NONE:
+        return true;
+    case COMMAND_DATA_SHARED:
+        GetSharedHeader(data)->refCount += 1;
+        target.data = data;
+#ifdef COMMAND_ALLOCATION_TRACKING
+        target.trackingSlot = trackingSlot;
+#endif
+        break;
+    case COMMAND_DATA_EXTERNAL:
+        target.data = data;
+        break;
+#if COMMAND_INLINE_DATA_SIZE > 0
+    case COMMAND_DATA_INLINE:
+        memcpy(target.inlineData, inlineData, dataSize);
+        break;
+#endif
+    default:
+        return false;
+    }
+
+    target.dataMode = dataMode;
+    target.dataSize = dataSize;
+    return true;
+}
+
+/**
+ * @brief Appends a segment to the scatter-gather payload of the command, the payload is sent as one
+ *        Command without copying the segments into one buffer. The first segment allocates the segment list.
+ * @param segmentData Pointer to the segment data
+ * @param size Size of the segment
+ * @param takeOwnership If true, the segment is freed with the Command, it must have been allocated with CommandPool::Allocate.
+ *        If false, the segment is an external buffer that must remain valid until the Command is reset.
+ * @return TRUE on success, FALSE if the command holds non-segmented data, the segment list is full, the total size
+ *         would exceed UINT16_MAX or the segment list cannot be allocated (pool exhausted in an ISR)
+*/
+bool Command::AddSegment(uint8_t* segmentData, uint16_t size, bool takeOwnership)
+{
+    if (segmentData == nullptr) {
+        return false;
+    }
+
+    // The total size is a uint16_t, a wrapped size would undersize the Flatten and MakeShared copies
+    const uint16_t totalSize = (dataMode == COMMAND_DATA_SEGMENTED) ? dataSize : 0;
+    if (size > UINT16_MAX - totalSize) {
+        return false;
+    }
+
+    if (dataMode != COMMAND_DATA_SEGMENTED) {
+        if (HasData()) {
+            return false;
+        }
+
+        uint8_t* listBlock = CommandPool::Allocate(sizeof(CommandSegmentList));
+        if (listBlock == nullptr) {
+            return false;
+        }
+
+        CommandSegmentList* list = ::new (listBlock) CommandSegmentList;
+        list->count = 0;
+
+        this->data = reinterpret_cast<uint8_t*>(list);
+        this->dataMode = COMMAND_DATA_SEGMENTED;
+        this->dataSize = 0;
+        CountAllocation(COMMAND_CALL_SITE());
+    }
+
+    CommandSegmentList* list = GetSegmentList(data);
+    if (list->count >= COMMAND_MAX_SEGMENTS) {
+        return false;
+    }
+
+    list->segments[list->count].data = segmentData;
+    list->segments[list->count].size = size;
+    list->segments[list->count].owned = takeOwnership;
+    list->count++;
+    dataSize += size;
+    return true;
+}
+
+/**
+ * @brief Allocates a segment from the CommandPool and appends it to the scatter-gather payload of the command
+ * @param size Size of the segment to allocate
+ * @return Pointer to the segment on success, nullptr on failure (see AddSegment, or pool exhausted in an ISR)
+*/
+uint8_t* Command::AllocateSegment(uint16_t size)
+{
+    // Check before allocating so a full list does not need to undo the allocation
+    if ((dataMode == COMMAND_DATA_SEGMENTED && GetSegmentList(data)->count >= COMMAND_MAX_SEGMENTS) ||
+        (dataMode != COMMAND_DATA_SEGMENTED && HasData())) {
+        return nullptr;
+    }
+
+    uint8_t* segment = CommandPool::Allocate(size);
+    if (segment == nullptr) {
+        return nullptr;
+    }
+
+    if (!AddSegment(segment, size, true)) {
+        CommandPool::Free(segment);
+        return nullptr;
+    }
+    return segment;
+}
+
+/**
+ * @brief Converts a scatter-gather payload into one contiguous allocated payload, this copies every segment.
+ *        Does nothing for commands that are not segmented.
+ * @return TRUE if the payload is contiguous after the call, FALSE if the pool is exhausted in an ISR (payload unchanged)
+*/
+bool Command::Flatten()
+{
+    if (dataMode != COMMAND_DATA_SEGMENTED) {
+        return true;
+    }
+
+    CommandSegmentList* list = GetSegmentList(data);
+    uint8_t* flat = CommandPool::Allocate(dataSize);
+    if (flat == nullptr) {
+        return false;
+    }
+
+    uint16_t offset = 0;
+    for (uint8_t i = 0; i < list->count; i++) {
+        memcpy(flat + offset, list->segments[i].data, list->segments[i].size);
+        offset += list->segments[i].size;
+    }
+
+    // The payload remains one allocation, so the allocation count and tracking record carry over
+    FreeSegmentList(list);
+    this->data = flat;
+    this->dataMode = COMMAND_DATA_ALLOCATED;
+    return true;
+}
+
+/**
+ * @brief Converts exclusively owned data (AllocateData, scatter-gather segments) into a reference counted block
+ *        that can be shared with ShareDataWith(), this copies the payload once. Does nothing for data that can
+ *        already be shared.
+ * @return TRUE if the data can be shared after the call, FALSE if the payload is too large for a shared block or
+ *         the pool is exhausted in an ISR (payload unchanged)
+*/
+bool Command::MakeShared()
+{
+    if (dataMode != COMMAND_DATA_ALLOCATED && dataMode != COMMAND_DATA_SEGMENTED) {
+        return true;
+    }
+
+    if (dataSize > COMMAND_MAX_SHARED_DATA_SIZE) {
+        return false;
+    }
+
+    uint8_t* block = CommandPool::Allocate(sizeof(CommandSharedHeader) + dataSize);
+    if (block == nullptr) {
+        return false;
+    }
+    CommandSharedHeader* header = ::new (block) CommandSharedHeader;
+    header->refCount = 1;
+    uint8_t* shared = block + sizeof(CommandSharedHeader);
+
+    if (dataMode == COMMAND_DATA_SEGMENTED) {
+        CommandSegmentList* list = GetSegmentList(data);
+        uint16_t offset = 0;
+        for (uint8_t i = 0; i < list->count; i++) {
+            memcpy(shared + offset, list->segments[i].data, list->segments[i].size);
+            offset += list->segments[i].size;
+        }
+        FreeSegmentList(list);
+    }
+    else {
+        memcpy(shared, data, dataSize);
+        CommandPool::Free(data);
+    }
+
+    // The payload remains one allocation, so the allocation count and tracking record carry over
+    this->data = shared;
+    this->dataMode = COMMAND_DATA_SHARED;
+    return true;
+}
+
+/**
+ * @brief Allocates exclusively owned or shared data, shared by the public allocation functions
+ * @param dataSize Size of array to allocate
+ * @param shared If true, allocates a reference counted block (never inline)
+ * @param callSite Call site of the public allocation function, used by allocation tracking
+ * @return Pointer to data on success, nullptr on failure (mem already allocated, shared size too large, or pool
+ *         exhausted in an ISR)
+*/
+uint8_t* Command::AllocateDataInternal(uint16_t dataSize, bool shared, const void* callSite)
+{
+    // If we already have data, we cannot allocate
+    if (HasData()) {
+        return nullptr;
+    }
+
+    if (shared) {
+        if (dataSize > COMMAND_MAX_SHARED_DATA_SIZE) {
+            return nullptr;
+        }
+
+        // Shared blocks carry their reference count in a header in front of the data
+        uint8_t* block = CommandPool::Allocate(sizeof(CommandSharedHeader) + dataSize);
+        if (block == nullptr) {
+            return nullptr;
+        }
+        CommandSharedHeader* header = ::new (block) CommandSharedHeader;
+        header->refCount = 1;
+
+        this->data = block + sizeof(CommandSharedHeader);
+        this->dataMode = COMMAND_DATA_SHARED;
+    }
+#if COMMAND_INLINE_DATA_SIZE > 0
+    else if (dataSize <= COMMAND_INLINE_DATA_SIZE) {
+        // Small payloads travel by value inside the Command, no allocation required
+        this->dataMode = COMMAND_DATA_INLINE;
+        this->dataSize = dataSize;
+        return this->inlineData;
+    }
+#endif
+    else {
+        uint8_t* block = CommandPool::Allocate(dataSize);
+        if (block == nullptr) {
+            return nullptr;
+        }
+
+        this->data = block;
+        this->dataMode = COMMAND_DATA_ALLOCATED;
+    }
+
+    this->dataSize = dataSize;
+    CountAllocation(callSite);
+    return this->data;
+}
+
+/**
+ * @brief Counts an allocation, asserts an error if the allocation count is too high
+ * @param callSite Call site of the allocation, recorded if allocation tracking is enabled
+*/
+void Command::CountAllocation(const void* callSite)
+{
+    statAllocationCounter += 1;
+
+#ifdef COMMAND_ALLOCATION_TRACKING
+    trackingSlot = CommandTracker::OnAllocate(command, taskCommand, callSite);
+#else
+    (void)callSite;
+#endif
+
+    //TODO: May want to print out whenever we have an imbalance in statAllocationCounter by more than ~5 or so.
+    CUBE_ASSERT(statAllocationCounter < MAX_NUMBER_OF_COMMAND_ALLOCATIONS);
+}
+
+/**
+ * @brief Counts the release of an allocation
+*/
+void Command::CountRelease()
+{
+    statAllocationCounter -= 1;
+
+#ifdef COMMAND_ALLOCATION_TRACKING
+    CommandTracker::OnRelease(trackingSlot);
+    trackingSlot = COMMAND_TRACKING_INVALID_SLOT;
+#endif
+}
+
 /**
  * @brief Resets command, equivalent of a destructor that must be called, counts allocations and deallocations, asserts an error if the allocation count is too high
 */
 void Command::Reset()
 {
-    if(bShouldFreeData && data != nullptr) {
-        cube_free(data);
-        statAllocationCounter -= 1;
-		data = nullptr;
-        bShouldFreeData = false;
+    if(dataMode == COMMAND_DATA_ALLOCATED && data != nullptr) {
+        CommandPool::Free(data);
+        CountRelease();
+        data = nullptr;
+        dataMode = COMMAND_DATA_NONE;
+    }
+    else if(dataMode == COMMAND_DATA_SHARED && data != nullptr) {
+        // Only the last Command referencing the block frees it
+        if (GetSharedHeader(data)->refCount.fetch_sub(1) == 1) {
+            CommandPool::Free(reinterpret_cast<uint8_t*>(GetSharedHeader(data)));
+            CountRelease();
+        }
+        data = nullptr;
+        dataMode = COMMAND_DATA_NONE;
+    }
+    else if(dataMode == COMMAND_DATA_SEGMENTED) {
+        FreeSegmentList(GetSegmentList(data));
+        CountRelease();
+        data = nullptr;
+        dataMode = COMMAND_DATA_NONE;
+    }
+    else if(dataMode == COMMAND_DATA_INLINE) {
+        data = nullptr;
+        dataMode = COMMAND_DATA_NONE;
     }
 }
 
@@ -161,7 +525,52 @@ void Command::Reset()
 */
 uint16_t Command::GetDataSize() const
 {
-    if (data == nullptr)
+    if (GetDataPointer() == nullptr)
         return 0;
     return dataSize;
 }
+
+/**
+ * @brief Getter for the total data size, including scatter-gather payloads
+ * @return Sum of the segment sizes for segmented data, otherwise the same as GetDataSize()
+*/
+uint16_t Command::GetTotalDataSize() const
+{
+    if (dataMode == COMMAND_DATA_SEGMENTED)
+        return dataSize;
+    return GetDataSize();
+}
+
+/**
+ * @brief Getter for the number of data segments
+ * @return Number of segments for segmented data, 1 for contiguous data, 0 if there is no data
+*/
+uint8_t Command::GetSegmentCount() const
+{
+    if (dataMode == COMMAND_DATA_SEGMENTED)
+        return GetSegmentList(data)->count;
+    return (GetDataPointer() != nullptr) ? 1 : 0;
+}
+
+/**
+ * @brief Getter for a data segment, contiguous data is segment 0
+ * @param index Index of the segment
+ * @param size Set to the size of the segment, 0 if the segment does not exist
+ * @return Pointer to the segment, nullptr if the segment does not exist
+*/
+uint8_t* Command::GetSegment(uint8_t index, uint16_t& size) const
+{
+    size = 0;
+    if (index >= GetSegmentCount()) {
+        return nullptr;
+    }
+
+    if (dataMode == COMMAND_DATA_SEGMENTED) {
+        const CommandSegmentList* list = GetSegmentList(data);
+        size = list->segments[index].size;
+        return list->segments[index].data;
+    }
+
+    size = GetDataSize();
+    return GetDataPointer();
+}
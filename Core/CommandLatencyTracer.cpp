@@ -0,0 +1,188 @@
+/**
+ ******************************************************************************
+ * File Name          : CommandLatencyTracer.cpp
+ * Description        : Implementation of Command latency tracing
+ ******************************************************************************
+*/
+#include "Core/Inc/CommandLatencyTracer.hpp"
+#include "Core/Inc/Command.hpp"
+
+#include <cstdio>      // Support for snprintf
+
+#include "CubeDefines.hpp"
+#include "SystemDefines.hpp"
+
+#ifdef COMMAND_LATENCY_TRACING
+
+/* Static Variable Init ------------------------------------------------------------------*/
+CommandLatencyTracer::LatencyKey CommandLatencyTracer::keys[COMMAND_LATENCY_MAX_KEYS];
+uint8_t CommandLatencyTracer::numKeys = 0;
+uint16_t CommandLatencyTracer::statDroppedSamples = 0;
+uint16_t CommandLatencyTracer::traceIdCounter = 0;
+
+/* Function Implementation ------------------------------------------------------------------*/
+
+/**
+ * @brief Enables the DWT cycle counter when it is the timestamp source, must be called before the first Command is
+ *        sent. Called by CubeTask::InitTask, call it earlier if Commands are sent before the Cube task is initialized.
+*/
+void CommandLatencyTracer::Init()
+{
+#ifdef COMMAND_LATENCY_USE_DWT
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/**
+ * @brief Stamps a command with the current time and a new trace ID, called by Queue on send. Safe to call from an ISR.
+ * @param cmd Command being sent
+*/
+void CommandLatencyTracer::Stamp(Command& cmd)
+{
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    // 0 marks an untraced command, skip it when the counter wraps
+    if (++traceIdCounter == 0) {
+        traceIdCounter = 1;
+    }
+    cmd.traceId = traceIdCounter;
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    cmd.enqueueTimestamp = COMMAND_LATENCY_TIMESTAMP();
+}
+
+/**
+ * @brief Records the time a command spent queued against the receiving task, called by Queue on receive
+ * @param cmd Received command
+*/
+void CommandLatencyTracer::RecordDequeue(const Command& cmd)
+{
+    Record(cmd, false);
+}
+
+/**
+ * @brief Records the time from enqueue to the end of the handler against the receiving task,
+ *        called by the task loop after handling the command (the payload may already be reset)
+ * @param cmd Handled command
+*/
+void CommandLatencyTracer::RecordHandled(const Command& cmd)
+{
+    Record(cmd, true);
+}
+
+/**
+ * @brief Prints the latency histograms of every task / command pair through CUBE_PRINT
+*/
+void CommandLatencyTracer::PrintHistograms()
+{
+    CUBE_PRINT("CMD LATENCY (us, log2 buckets <1,<2,<4..) dropped %d\r\n", statDroppedSamples);
+
+    for (uint8_t i = 0; i < numKeys; i++) {
+        // Copy the entry so it is consistent while printing
+        UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+        const LatencyKey key = keys[i];
+        taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+        CUBE_PRINT("  task %s cmd %d/%d\r\n",
+            (key.task != nullptr) ? pcTaskGetName(key.task) : "NONE", key.command, key.taskCommand);
+        PrintHistogram("queued", key.queued);
+        PrintHistogram("e2e", key.endToEnd);
+    }
+}
+
+/**
+ * @brief Clears every histogram and the key table
+*/
+void CommandLatencyTracer::ClearHistograms()
+{
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    numKeys = 0;
+    statDroppedSamples = 0;
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+}
+
+/**
+ * @brief Records the latency of a command in the histogram of the current task
+ * @param cmd Command to record
+ * @param handled If true records into the end-to-end histogram, otherwise into the queued histogram
+*/
+void CommandLatencyTracer::Record(const Command& cmd, bool handled)
+{
+    // Commands that were never sent through a Queue have no timestamp
+    if (cmd.traceId == 0) {
+        return;
+    }
+
+    const uint32_t latencyUs = (COMMAND_LATENCY_TIMESTAMP() - cmd.enqueueTimestamp) / COMMAND_LATENCY_COUNTS_PER_US;
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    const uint8_t index = FindOrAddKey(task, cmd.GetCommand(), cmd.GetTaskCommand());
+    if (index < COMMAND_LATENCY_MAX_KEYS) {
+        AddSample(handled ? keys[index].endToEnd : keys[index].queued, latencyUs);
+    }
+    else {
+        statDroppedSamples += 1;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+}
+
+/**
+ * @brief Adds a sample to a histogram. Must be called in a critical section.
+*/
+void CommandLatencyTracer::AddSample(LatencyHistogram& hist, uint32_t latencyUs)
+{
+    // Bucket n holds [2^(n-1), 2^n) us, bucket 0 is < 1us
+    uint8_t bucket = (latencyUs == 0) ? 0 : static_cast<uint8_t>(32 - __builtin_clz(latencyUs));
+    if (bucket >= COMMAND_LATENCY_NUM_BUCKETS) {
+        bucket = COMMAND_LATENCY_NUM_BUCKETS - 1;
+    }
+
+    if (hist.buckets[bucket] < UINT16_MAX) {
+        hist.buckets[bucket] += 1;
+    }
+    if (latencyUs > hist.maxUs) {
+        hist.maxUs = latencyUs;
+    }
+}
+
+/**
+ * @brief Prints one histogram on a single line, trailing empty buckets are omitted
+*/
+void CommandLatencyTracer::PrintHistogram(const char* name, const LatencyHistogram& hist)
+{
+    uint8_t numBuckets = COMMAND_LATENCY_NUM_BUCKETS;
+    while (numBuckets > 0 && hist.buckets[numBuckets - 1] == 0) {
+        numBuckets--;
+    }
+
+    char line[DEBUG_PRINT_MAX_SIZE];
+    int len = snprintf(line, sizeof(line), "    %s max %lu:", name, static_cast<unsigned long>(hist.maxUs));
+    for (uint8_t i = 0; i < numBuckets && len > 0 && len < static_cast<int>(sizeof(line)); i++) {
+        len += snprintf(line + len, sizeof(line) - len, " %u", hist.buckets[i]);
+    }
+    CUBE_PRINT("%s\r\n", line);
+}
+
+/**
+ * @brief Finds the histogram entry for a task / command pair, adding a cleared entry if there is space.
+ *        Must be called in a critical section.
+ * @return Index of the entry, COMMAND_LATENCY_MAX_KEYS if the table is full
+*/
+uint8_t CommandLatencyTracer::FindOrAddKey(TaskHandle_t task, GLOBAL_COMMANDS command, uint16_t taskCommand)
+{
+    for (uint8_t i = 0; i < numKeys; i++) {
+        if (keys[i].task == task && keys[i].command == command && keys[i].taskCommand == taskCommand) {
+            return i;
+        }
+    }
+
+    if (numKeys >= COMMAND_LATENCY_MAX_KEYS) {
+        return COMMAND_LATENCY_MAX_KEYS;
+    }
+
+    keys[numKeys] = { task, taskCommand, command, {}, {} };
+    return numKeys++;
+}
+
+#endif /* COMMAND_LATENCY_TRACING */
@@ -0,0 +1,150 @@
+/**
+ ******************************************************************************
+ * File Name          : CommandLoan.cpp
+ * Description        : Implementation of the CommandLoan class
+ ******************************************************************************
+*/
+#include "Core/Inc/CommandLoan.hpp"
+
+#include <cstring>
+#include "Core/Inc/CommandPool.hpp"
+#include "CubeDefines.hpp"
+#include "SystemDefines.hpp"
+
+/**
+ * @brief Constructor, borrows a writable payload buffer of the given size. In an ISR there is no heap fallback,
+ *        the loan is invalid (IsValid() is false) if the CommandPool cannot serve the size.
+ * @param command GLOBAL_COMMANDS of the Command the buffer will be committed as
+ * @param taskCommand Task specific command of the Command the buffer will be committed as
+ * @param size Size of the buffer to borrow in bytes
+*/
+CommandLoan::CommandLoan(GLOBAL_COMMANDS command, uint16_t taskCommand, uint16_t size) :
+    cmd(command, taskCommand),
+    size(size)
+{
+    cmd.AllocateData(size);
+}
+
+/**
+ * @brief Destructor, releases the buffer if the loan was never committed
+*/
+CommandLoan::~CommandLoan()
+{
+    Release();
+}
+
+/**
+ * @brief Sends the first usedSize bytes of the buffer to the queue as a Command, ownership of the buffer
+ *        passes to the queue on success. On failure the buffer is released (Queue::Send resets the Command).
+ * @param queue Queue to send the Command to
+ * @param usedSize Number of bytes of the buffer that were written, must not exceed GetSize()
+ * @param reportFull If true (default), prints an error message if the queue is full
+ * @return true on success, false on failure (invalid loan, or queue full)
+*/
+bool CommandLoan::Commit(Queue& queue, uint16_t usedSize, bool reportFull)
+{
+    if (!PrepareCommit(usedSize)) {
+        return false;
+    }
+
+    bool sent = queue.Send(cmd, reportFull);
+
+    // Either the queue owns the buffer now, or Send released it, forget it in both cases
+    cmd = Command();
+    return sent;
+}
+
+/**
+ * @brief Commit, safe to call from an ISR
+ * @param queue Queue to send the Command to
+ * @param usedSize Number of bytes of the buffer that were written, must not exceed GetSize()
+ * @param pxHigherPriorityTaskWoken See Queue::SendFromISR, nullptr (default) requests the context switch internally
+ * @return true on success, false on failure (invalid loan, or queue full)
+*/
+bool CommandLoan::CommitFromISR(Queue& queue, uint16_t usedSize, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    if (!PrepareCommit(usedSize)) {
+        return false;
+    }
+
+    bool sent = queue.SendFromISR(cmd, pxHigherPriorityTaskWoken);
+
+    cmd = Command();
+    return sent;
+}
+
+/**
+ * @brief Releases the buffer without sending it, the loan becomes invalid
+*/
+void CommandLoan::Release()
+{
+    cmd.Reset();
+    cmd = Command();
+}
+
+/**
+ * @brief Checks the loan can be committed and trims the Command to the used size, releases the loan on error
+ * @param usedSize Number of bytes of the buffer that were written
+ * @return true if the loan is valid and usedSize fits in the buffer
+*/
+bool CommandLoan::PrepareCommit(uint16_t usedSize)
+{
+    if (!IsValid() || usedSize > size) {
+        Release();
+        return false;
+    }
+
+    cmd.SetDataSize(usedSize);
+    Trim(usedSize);
+    return true;
+}
+
+/**
+ * @brief Moves the used part of the buffer into a smaller CommandPool block (or inline) when it fits one, so a
+ *        loan sized for the longest payload does not keep a large block while it waits in a queue. The copy is
+ *        usedSize bytes, if no smaller block is available (or the pool is exhausted in an ISR) the buffer is
+ *        committed as it is.
+ * @param usedSize Number of bytes of the buffer that were written
+*/
+void CommandLoan::Trim(uint16_t usedSize)
+{
+#ifndef COMMAND_POOL_DISABLE
+    if (cmd.GetDataMode() != COMMAND_DATA_ALLOCATED || usedSize == 0 || FittingBlockSize(usedSize) >= FittingBlockSize(size)) {
+        return;
+    }
+
+    Command trimmed(cmd.GetCommand(), cmd.GetTaskCommand());
+    uint8_t* dest = trimmed.AllocateData(usedSize);
+    if (dest == nullptr) {
+        return;
+    }
+
+    memcpy(dest, cmd.GetDataPointer(), usedSize);
+    cmd.Reset();
+    cmd = trimmed;
+    size = usedSize;
+#else
+    (void)usedSize;
+#endif
+}
+
+/**
+ * @brief Block size that serves a payload of the given size, inline storage counts as 0
+ * @param size Payload size in bytes
+ * @return Size of the smallest fitting pool class, or size itself if it is larger than every class
+*/
+uint16_t CommandLoan::FittingBlockSize(uint16_t size)
+{
+#if COMMAND_INLINE_DATA_SIZE > 0
+    if (size <= COMMAND_INLINE_DATA_SIZE) {
+        return 0;
+    }
+#endif
+    for (uint8_t i = 0; i < COMMAND_POOL_NUM_CLASSES; i++) {
+        const uint16_t blockSize = CommandPool::GetBlockSize(static_cast<CommandPoolClass>(i));
+        if (size <= blockSize) {
+            return blockSize;
+        }
+    }
+    return size;
+}
@@ -0,0 +1,339 @@
+/**
+ ******************************************************************************
+ * File Name          : CommandMailbox.cpp
+ * Description        : Implementation of the latest value per taskCommand mailbox
+ ******************************************************************************
+*/
+#include "Core/Inc/CommandMailbox.hpp"
+
+#include "CubeUtils.hpp"
+#include "SystemDefines.hpp"
+#include "semphr.h"
+
+/* Function Implementation ------------------------------------------------------------------*/
+
+/**
+ * @brief Constructor for the CommandMailbox class
+ * @param numKeys Number of distinct taskCommand values the mailbox holds, max COMMAND_MAILBOX_MAX_KEYS
+*/
+CommandMailbox::CommandMailbox(uint8_t numKeys)
+{
+    CUBE_ASSERT(numKeys > 0 && numKeys <= COMMAND_MAILBOX_MAX_KEYS, "CommandMailbox - invalid number of keys");
+
+    slots = new Slot[numKeys];
+    ownsSlots = true;
+    this->numKeys = numKeys;
+    numUsedKeys = 0;
+    nextSlot = 0;
+    pendingMask = 0;
+
+    statReplacedCounter = 0;
+    statRejectedCounter = 0;
+
+    rtSemaphoreHandle = xSemaphoreCreateBinary();
+    CUBE_ASSERT(rtSemaphoreHandle != NULL, "CommandMailbox - semaphore creation failed");
+}
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+/**
+ * @brief Constructor for statically allocated mailboxes, uses the given slots and creates the semaphore in the given
+ *        storage (see StaticCommandMailbox)
+ * @param numKeys Number of distinct taskCommand values the mailbox holds, max COMMAND_MAILBOX_MAX_KEYS
+ * @param slots Slot storage of numKeys entries
+ * @param rtSemaphoreBuffer RTOS semaphore control block storage
+*/
+CommandMailbox::CommandMailbox(uint8_t numKeys, Slot* slots, StaticSemaphore_t* rtSemaphoreBuffer)
+{
+    CUBE_ASSERT(numKeys > 0 && numKeys <= COMMAND_MAILBOX_MAX_KEYS, "CommandMailbox - invalid number of keys");
+
+    this->slots = slots;
+    ownsSlots = false;
+    this->numKeys = numKeys;
+    numUsedKeys = 0;
+    nextSlot = 0;
+    pendingMask = 0;
+
+    statReplacedCounter = 0;
+    statRejectedCounter = 0;
+
+    rtSemaphoreHandle = xSemaphoreCreateBinaryStatic(rtSemaphoreBuffer);
+    CUBE_ASSERT(rtSemaphoreHandle != NULL, "CommandMailbox - xSemaphoreCreateBinaryStatic() failed");
+}
+#endif
+
+/**
+ * @brief Destructor for the CommandMailbox class, frees every pending payload
+*/
+CommandMailbox::~CommandMailbox()
+{
+    Clear();
+    vSemaphoreDelete(rtSemaphoreHandle);
+    if (ownsSlots)
+        delete[] slots;
+}
+
+/**
+ * @brief Sends a command to the mailbox, a pending command with the same taskCommand is replaced and reset
+ * @param command Command object reference to send, ownership of the payload moves into the mailbox
+ * @param reportFull If true (default), prints an error message if the command has a new key and every slot is claimed
+ * @return true on success, false on failure (no free slot for a new key, the command is reset)
+*/
+bool CommandMailbox::Send(Command& command, bool reportFull)
+{
+    if (SendInternal(command, nullptr))
+        return true;
+
+    if (reportFull) CUBE_PRINT("Could not send data to mailbox, no free key slot!\n");
+
+    command.Reset();
+
+    return false;
+}
+
+/**
+ * @brief Sends a command to the mailbox, safe to call from ISR
+ * @param command Command object reference to send
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the send woke a higher priority task, the caller must then call
+ *        portYIELD_FROM_ISR before the ISR exits. If nullptr (default), the context switch is requested internally.
+ * @return true on success, false on failure (no free slot for a new key, the command is reset)
+*/
+bool CommandMailbox::SendFromISR(Command& command, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    const bool success = SendInternal(command, &higherPriorityTaskWoken);
+    Utils::YieldFromISR(higherPriorityTaskWoken, pxHigherPriorityTaskWoken);
+
+    if (success)
+        return true;
+
+    command.Reset();
+
+    return false;
+}
+
+/**
+ * @brief Receives the next changed key, blocks for timeout_ms if no key is pending
+ * @param cm Command object to copy the newest command of the key into
+ * @param timeout_ms Time to block for
+ * @return TRUE if we received a command, FALSE otherwise
+*/
+bool CommandMailbox::Receive(Command& cm, uint32_t timeout_ms)
+{
+    return ReceiveInternal(&cm, 1, MS_TO_TICKS(timeout_ms), nullptr) == 1;
+}
+
+/**
+ * @brief Blocks forever until a key changes and receives it
+ * @param cm Command object to copy the newest command of the key into
+ * @return TRUE if we received a command, FALSE otherwise (should rarely return false)
+*/
+bool CommandMailbox::ReceiveWait(Command& cm)
+{
+    return ReceiveInternal(&cm, 1, HAL_MAX_DELAY, nullptr) == 1;
+}
+
+/**
+ * @brief Receives the next changed key without blocking, safe to call from ISR
+ * @param cm Command object to copy the newest command of the key into
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if a higher priority task was woken, nullptr (default) to request
+ *        the context switch internally
+ * @return TRUE if we received a command, FALSE if no key is pending
+*/
+bool CommandMailbox::ReceiveFromISR(Command& cm, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    const bool success = (ReceiveInternal(&cm, 1, 0, &higherPriorityTaskWoken) == 1);
+    Utils::YieldFromISR(higherPriorityTaskWoken, pxHigherPriorityTaskWoken);
+    return success;
+}
+
+/**
+ * @brief Receives every changed key (up to maxCount), blocks for timeout_ms if no key is pending
+ * @param cms Array of Command objects to copy the received commands into
+ * @param maxCount Size of the array
+ * @param timeout_ms Time to block for
+ * @return Number of commands received
+*/
+uint16_t CommandMailbox::ReceiveChanged(Command cms[], uint16_t maxCount, uint32_t timeout_ms)
+{
+    return ReceiveInternal(cms, maxCount, MS_TO_TICKS(timeout_ms), nullptr);
+}
+
+/**
+ * @brief Blocks forever until a key changes, then receives every changed key (up to maxCount)
+ * @param cms Array of Command objects to copy the received commands into
+ * @param maxCount Size of the array
+ * @return Number of commands received (should rarely return 0)
+*/
+uint16_t CommandMailbox::ReceiveChangedWait(Command cms[], uint16_t maxCount)
+{
+    return ReceiveInternal(cms, maxCount, HAL_MAX_DELAY, nullptr);
+}
+
+/**
+ * @brief Drops every pending command and frees its payload, claimed keys keep their slots
+*/
+void CommandMailbox::Clear()
+{
+    for (uint8_t i = 0; i < numKeys; i++) {
+        Command dropped;
+        bool wasPending = false;
+
+        UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+        if (pendingMask & (1UL << i)) {
+            dropped = slots[i].command;
+            pendingMask &= ~(1UL << i);
+            wasPending = true;
+
+            if (pendingMask == 0)
+                xSemaphoreTakeFromISR(rtSemaphoreHandle, NULL);
+        }
+        taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+        if (wasPending)
+            dropped.Reset();
+    }
+}
+
+/**
+ * @brief Checks if a key has a command that has not been received yet
+ * @param taskCommand Key to check
+ * @return TRUE if the key is pending
+*/
+bool CommandMailbox::IsPending(uint16_t taskCommand) const
+{
+    const int16_t index = FindSlot(taskCommand);
+    return index >= 0 && (pendingMask & (1UL << index)) != 0;
+}
+
+/**
+ * @brief Stores a command in the slot of its key, claiming a slot for a new key. The semaphore is given when the
+ *        first key becomes pending. Does not reset the command on failure.
+ * @param command Command object reference to send
+ * @param isrTaskWoken nullptr in task context, in an ISR this collects the higher priority task woken flag
+ * @return true on success, false if the key is new and every slot is claimed
+*/
+bool CommandMailbox::SendInternal(Command& command, BaseType_t* isrTaskWoken)
+{
+    COMMAND_TRACE_STAMP(command);
+
+    Command replaced;
+    bool hasReplaced = false;
+    bool success = false;
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+
+    int16_t index = FindSlot(command.GetTaskCommand());
+    if (index < 0 && numUsedKeys < numKeys) {
+        index = numUsedKeys++;
+        slots[index].taskCommand = command.GetTaskCommand();
+    }
+
+    if (index >= 0) {
+        const uint32_t bit = 1UL << index;
+        if (pendingMask & bit) {
+            replaced = slots[index].command;
+            hasReplaced = true;
+            statReplacedCounter += 1;
+        }
+
+        slots[index].command = command;
+
+        if (pendingMask == 0)
+            xSemaphoreGiveFromISR(rtSemaphoreHandle, &higherPriorityTaskWoken);
+        pendingMask |= bit;
+        success = true;
+    }
+    else {
+        statRejectedCounter += 1;
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    // Free the stale payload outside the critical section
+    if (hasReplaced)
+        replaced.Reset();
+
+    FinishSignal(higherPriorityTaskWoken, isrTaskWoken);
+
+    return success;
+}
+
+/**
+ * @brief Waits for the semaphore, then takes up to maxCount pending commands round robin from the slot after
+ *        the last one received. The semaphore is given back if keys remain pending, so every successful take
+ *        of the semaphore (including one made by a Task queue set) is matched by exactly one receive.
+ * @param cms Array of Command objects to copy the received commands into
+ * @param maxCount Size of the array
+ * @param waitTicks Ticks to block for, ignored in an ISR
+ * @param isrTaskWoken nullptr in task context, in an ISR this collects the higher priority task woken flag
+ * @return Number of commands received
+*/
+uint16_t CommandMailbox::ReceiveInternal(Command cms[], uint16_t maxCount, TickType_t waitTicks, BaseType_t* isrTaskWoken)
+{
+    if (maxCount == 0)
+        return 0;
+
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    const BaseType_t taken = (isrTaskWoken != nullptr) ? xSemaphoreTakeFromISR(rtSemaphoreHandle, &higherPriorityTaskWoken)
+                                                       : xSemaphoreTake(rtSemaphoreHandle, waitTicks);
+    if (taken != pdTRUE)
+        return 0;
+
+    uint16_t numReceived = 0;
+
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+
+    while (numReceived < maxCount && pendingMask != 0) {
+        // Lowest pending slot at or after nextSlot, wrapping around to the lowest pending slot
+        const uint32_t fromNext = pendingMask & ~((1UL << nextSlot) - 1);
+        const uint8_t index = static_cast<uint8_t>(__builtin_ctz((fromNext != 0) ? fromNext : pendingMask));
+
+        cms[numReceived++] = slots[index].command;
+        pendingMask &= ~(1UL << index);
+        nextSlot = (index + 1 < numKeys) ? index + 1 : 0;
+    }
+
+    if (pendingMask != 0)
+        xSemaphoreGiveFromISR(rtSemaphoreHandle, &higherPriorityTaskWoken);
+
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    FinishSignal(higherPriorityTaskWoken, isrTaskWoken);
+
+    for (uint16_t i = 0; i < numReceived; i++)
+        COMMAND_TRACE_DEQUEUE(cms[i]);
+
+    return numReceived;
+}
+
+/**
+ * @brief Finishes the higher priority task woken handling of a semaphore call made in a critical section. In an ISR
+ *        the flag is passed on to the FromISR caller, in a task the task yields right away.
+ * @param higherPriorityTaskWoken Woken state collected by the semaphore calls
+ * @param isrTaskWoken nullptr in task context, otherwise the FromISR woken flag
+*/
+void CommandMailbox::FinishSignal(BaseType_t higherPriorityTaskWoken, BaseType_t* isrTaskWoken)
+{
+    if (isrTaskWoken != nullptr) {
+        if (higherPriorityTaskWoken == pdTRUE) *isrTaskWoken = pdTRUE;
+    }
+    else if (higherPriorityTaskWoken == pdTRUE) {
+        taskYIELD();
+    }
+}
+
+/**
+ * @brief Finds the slot claimed by a key
+ * @param taskCommand Key to find
+ * @return Index of the slot, -1 if the key has not claimed a slot
+*/
+int16_t CommandMailbox::FindSlot(uint16_t taskCommand) const
+{
+    for (uint8_t i = 0; i < numUsedKeys; i++) {
+        if (slots[i].taskCommand == taskCommand)
+            return i;
+    }
+    return -1;
+}
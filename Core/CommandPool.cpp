@@ -0,0 +1,160 @@
+/**
+ ******************************************************************************
+ * File Name          : CommandPool.cpp
+ * Description        : Implementation of the Command payload block pool
+ *
+ * Every pool operation runs inside an interrupt mask critical section, which
+ * is valid in both task and interrupt context. The critical section only
+ * covers the free-list update, so it is a constant handful of instructions.
+ *
+ ******************************************************************************
+*/
+#include "Core/Inc/CommandPool.hpp"
+
+#include "etl/generic_pool.h"
+#include "CubeDefines.hpp"
+#include "SystemDefines.hpp"
+
+/* Static Variable Init ------------------------------------------------------------------*/
+uint16_t CommandPool::statMinAvailable[COMMAND_POOL_NUM_CLASSES] = {
+    COMMAND_POOL_SMALL_BLOCK_COUNT,
+    COMMAND_POOL_MEDIUM_BLOCK_COUNT,
+    COMMAND_POOL_LARGE_BLOCK_COUNT
+};
+uint16_t CommandPool::statHeapFallbackCounter = 0;
+
+#ifndef COMMAND_POOL_DISABLE
+namespace {
+    etl::generic_pool<COMMAND_POOL_SMALL_BLOCK_SIZE, COMMAND_POOL_BLOCK_ALIGNMENT, COMMAND_POOL_SMALL_BLOCK_COUNT> smallPool;
+    etl::generic_pool<COMMAND_POOL_MEDIUM_BLOCK_SIZE, COMMAND_POOL_BLOCK_ALIGNMENT, COMMAND_POOL_MEDIUM_BLOCK_COUNT> mediumPool;
+    etl::generic_pool<COMMAND_POOL_LARGE_BLOCK_SIZE, COMMAND_POOL_BLOCK_ALIGNMENT, COMMAND_POOL_LARGE_BLOCK_COUNT> largePool;
+
+    // Pools in increasing block size order, indexed by CommandPoolClass
+    etl::ipool* const pools[COMMAND_POOL_NUM_CLASSES] = { &smallPool, &mediumPool, &largePool };
+    const uint16_t blockSizes[COMMAND_POOL_NUM_CLASSES] = {
+        COMMAND_POOL_SMALL_BLOCK_SIZE,
+        COMMAND_POOL_MEDIUM_BLOCK_SIZE,
+        COMMAND_POOL_LARGE_BLOCK_SIZE
+    };
+}
+#endif
+
+/* Function Implementation ------------------------------------------------------------------*/
+
+/**
+ * @brief Allocates a block of at least size bytes from the smallest class that fits and has
+ *        a free block, falls back to cube_malloc for oversize requests or exhausted classes.
+ *        In an ISR there is no heap fallback, the request fails instead.
+ * @param size Size of the block to allocate in bytes
+ * @return Pointer to the block, nullptr if the pool cannot serve the request in an ISR, asserts on heap failure
+*/
+uint8_t* CommandPool::Allocate(uint16_t size)
+{
+#ifndef COMMAND_POOL_DISABLE
+    for (uint8_t i = 0; i < COMMAND_POOL_NUM_CLASSES; i++) {
+        if (size > blockSizes[i]) {
+            continue;
+        }
+
+        UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+        uint8_t* block = nullptr;
+        if (!pools[i]->full()) {
+            block = pools[i]->allocate<uint8_t>();
+
+            const uint16_t available = pools[i]->available();
+            if (available < statMinAvailable[i]) {
+                statMinAvailable[i] = available;
+            }
+        }
+        taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+        if (block != nullptr) {
+            return block;
+        }
+    }
+#endif
+
+    // Oversize, every fitting class is exhausted or the pool is disabled, the heap is not usable from an ISR
+    if (xPortIsInsideInterrupt()) {
+        return nullptr;
+    }
+
+#ifndef COMMAND_POOL_DISABLE
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    statHeapFallbackCounter += 1;
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+#endif
+    return cube_malloc(size);
+}
+
+/**
+ * @brief Returns a block to the class it was allocated from, or to the heap if it
+ *        was not served by the pool
+ * @param ptr Pointer to the block, must have been returned by Allocate, may be nullptr
+*/
+void CommandPool::Free(uint8_t* ptr)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+
+#ifndef COMMAND_POOL_DISABLE
+    for (uint8_t i = 0; i < COMMAND_POOL_NUM_CLASSES; i++) {
+        if (pools[i]->is_in_pool(ptr)) {
+            UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+            pools[i]->release(ptr);
+            taskEXIT_CRITICAL_FROM_ISR(savedMask);
+            return;
+        }
+    }
+#endif
+
+    cube_free(ptr);
+}
+
+/**
+ * @brief Checks if a pointer was served by one of the pool classes
+ * @param ptr Pointer to check
+ * @return TRUE if the pointer lies inside a pool class, FALSE if it is a heap (or foreign) pointer
+*/
+bool CommandPool::IsPoolBlock(const uint8_t* ptr)
+{
+#ifndef COMMAND_POOL_DISABLE
+    for (uint8_t i = 0; i < COMMAND_POOL_NUM_CLASSES; i++) {
+        if (pools[i]->is_in_pool(ptr)) {
+            return true;
+        }
+    }
+#endif
+    return false;
+}
+
+/**
+ * @brief Getter for the block size of a pool class
+ * @param poolClass Pool class to query
+ * @return Block size in bytes, 0 if the pool is disabled
+*/
+uint16_t CommandPool::GetBlockSize(CommandPoolClass poolClass)
+{
+#ifndef COMMAND_POOL_DISABLE
+    if (poolClass < COMMAND_POOL_NUM_CLASSES) {
+        return blockSizes[poolClass];
+    }
+#endif
+    return 0;
+}
+
+/**
+ * @brief Getter for the number of free blocks in a pool class
+ * @param poolClass Pool class to query
+ * @return Number of free blocks, 0 if the pool is disabled
+*/
+uint16_t CommandPool::GetAvailableBlocks(CommandPoolClass poolClass)
+{
+#ifndef COMMAND_POOL_DISABLE
+    if (poolClass < COMMAND_POOL_NUM_CLASSES) {
+        return pools[poolClass]->available();
+    }
+#endif
+    return 0;
+}
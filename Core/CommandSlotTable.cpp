@@ -0,0 +1,106 @@
+/**
+ ******************************************************************************
+ * File Name          : CommandSlotTable.cpp
+ * Description        : Implementation of the handle addressed Command slot table
+ ******************************************************************************
+*/
+#include "Core/Inc/CommandSlotTable.hpp"
+
+#include "CubeDefines.hpp"
+#include "SystemDefines.hpp"
+
+/* Static Variable Init ------------------------------------------------------------------*/
+Command CommandSlotTable::slots[COMMAND_SLOT_TABLE_SIZE];
+uint16_t CommandSlotTable::generations[COMMAND_SLOT_TABLE_SIZE];
+uint16_t CommandSlotTable::freeSlots[COMMAND_SLOT_TABLE_SIZE];
+uint16_t CommandSlotTable::numFreeSlots = 0;
+uint16_t CommandSlotTable::numInitialisedSlots = 0;
+
+uint16_t CommandSlotTable::statMinFreeSlots = COMMAND_SLOT_TABLE_SIZE;
+uint16_t CommandSlotTable::statStaleHandleCounter = 0;
+
+/* Function Implementation ------------------------------------------------------------------*/
+
+/**
+ * @brief Parks a Command in a free slot. The Command is moved into the table, the caller's object
+ *        must not be reset afterwards (same as sending it to a Queue). Safe to call from an ISR.
+ * @param command Command to park
+ * @return Handle of the slot, COMMAND_HANDLE_INVALID if the table is full
+*/
+CommandHandle_t CommandSlotTable::Store(Command& command)
+{
+    CommandHandle_t handle = COMMAND_HANDLE_INVALID;
+
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+
+    // Take a free slot, slots that were never used are handed out in order
+    uint16_t index = 0xFFFF;
+    if (numFreeSlots > 0) {
+        index = freeSlots[--numFreeSlots];
+    }
+    else if (numInitialisedSlots < COMMAND_SLOT_TABLE_SIZE) {
+        index = numInitialisedSlots++;
+    }
+
+    if (index != 0xFFFF) {
+        generations[index] += 1;    // Now odd, the slot is live
+        slots[index] = command;
+        handle = (static_cast<CommandHandle_t>(generations[index]) << 16) | index;
+
+        const uint16_t numFree = GetFreeSlots();
+        if (numFree < statMinFreeSlots) {
+            statMinFreeSlots = numFree;
+        }
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    return handle;
+}
+
+/**
+ * @brief Moves a parked Command out of the table and releases its slot, the handle is invalid afterwards.
+ *        Safe to call from an ISR.
+ * @param handle Handle returned by Store
+ * @param command Command object to move the parked Command into
+ * @return TRUE on success, FALSE if the handle is stale (already taken) or invalid, command is left untouched
+*/
+bool CommandSlotTable::Take(CommandHandle_t handle, Command& command)
+{
+    const uint16_t index = GetIndex(handle);
+    const uint16_t generation = GetGeneration(handle);
+    bool success = false;
+
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+
+    if (index < numInitialisedSlots && generations[index] == generation && (generation & 1) != 0) {
+        command = slots[index];
+        generations[index] += 1;    // Now even, the slot is free and old handles are stale
+        freeSlots[numFreeSlots++] = index;
+        success = true;
+    }
+    else {
+        statStaleHandleCounter += 1;
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    return success;
+}
+
+/**
+ * @brief Gets the parked Command of a live handle without releasing the slot. The pointer is only valid until
+ *        the handle is taken, so this must be called in a critical section that also covers every use of the pointer.
+ * @param handle Handle returned by Store
+ * @return Pointer to the parked Command, nullptr if the handle is stale or invalid
+*/
+const Command* CommandSlotTable::Peek(CommandHandle_t handle)
+{
+    const uint16_t index = GetIndex(handle);
+    const uint16_t generation = GetGeneration(handle);
+
+    if (index < numInitialisedSlots && generations[index] == generation && (generation & 1) != 0) {
+        return &slots[index];
+    }
+    return nullptr;
+}
@@ -0,0 +1,246 @@
+/**
+ ******************************************************************************
+ * File Name          : CommandTracker.cpp
+ * Description        : Implementation of Command allocation tracking
+ ******************************************************************************
+*/
+#include "Core/Inc/CommandTracker.hpp"
+
+#include "CubeDefines.hpp"
+#include "SystemDefines.hpp"
+
+#ifdef COMMAND_ALLOCATION_TRACKING
+
+/* Static Variable Init ------------------------------------------------------------------*/
+CommandAllocationRecord CommandTracker::records[COMMAND_TRACKING_MAX_RECORDS];
+uint8_t CommandTracker::freeSlots[COMMAND_TRACKING_MAX_RECORDS];
+uint8_t CommandTracker::numFreeSlots = 0;
+uint8_t CommandTracker::numInitialisedSlots = 0;
+
+CommandTracker::KeyStat CommandTracker::keyStats[COMMAND_TRACKING_MAX_KEYS];
+uint8_t CommandTracker::numKeys = 0;
+CommandTracker::TaskStat CommandTracker::taskStats[COMMAND_TRACKING_MAX_TASKS];
+uint8_t CommandTracker::numTasks = 0;
+
+CommandTrackingStat CommandTracker::statGlobal = {};
+uint16_t CommandTracker::statUntracked = 0;
+
+/* Function Implementation ------------------------------------------------------------------*/
+
+/**
+ * @brief Records a new allocation, called by Command when payload memory is allocated. Safe to call from an ISR.
+ * @param command GLOBAL_COMMANDS of the allocating Command
+ * @param taskCommand taskCommand of the allocating Command
+ * @param callSite Return address of the allocating call
+ * @return Record slot to store in the Command, COMMAND_TRACKING_INVALID_SLOT if the record table is full
+*/
+uint8_t CommandTracker::OnAllocate(GLOBAL_COMMANDS command, uint16_t taskCommand, const void* callSite)
+{
+    const bool inIsr = xPortIsInsideInterrupt();
+    TaskHandle_t task = inIsr ? nullptr : xTaskGetCurrentTaskHandle();
+    const uint32_t tick = inIsr ? xTaskGetTickCountFromISR() : xTaskGetTickCount();
+
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+
+    // Take a free record slot, slots that were never used are handed out in order
+    uint8_t slot = COMMAND_TRACKING_INVALID_SLOT;
+    if (numFreeSlots > 0) {
+        slot = freeSlots[--numFreeSlots];
+    }
+    else if (numInitialisedSlots < COMMAND_TRACKING_MAX_RECORDS) {
+        slot = numInitialisedSlots++;
+    }
+
+    CountAllocation(statGlobal);
+
+    if (slot == COMMAND_TRACKING_INVALID_SLOT) {
+        statUntracked += 1;
+    }
+    else {
+        CommandAllocationRecord& record = records[slot];
+        record.callSite = callSite;
+        record.task = task;
+        record.allocTick = tick;
+        record.taskCommand = taskCommand;
+        record.command = command;
+        record.keyIndex = FindOrAddKey(command, taskCommand);
+        record.taskIndex = FindOrAddTask(task);
+        record.inUse = true;
+
+        if (record.keyIndex != COMMAND_TRACKING_INVALID_SLOT) {
+            CountAllocation(keyStats[record.keyIndex].stat);
+        }
+        if (record.taskIndex != COMMAND_TRACKING_INVALID_SLOT) {
+            CountAllocation(taskStats[record.taskIndex].stat);
+        }
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    return slot;
+}
+
+/**
+ * @brief Records the release of an allocation, called by Command when payload memory is freed. Safe to call from an ISR.
+ * @param slot Record slot returned by OnAllocate
+*/
+void CommandTracker::OnRelease(uint8_t slot)
+{
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+
+    if (statGlobal.liveCount > 0) {
+        statGlobal.liveCount -= 1;
+    }
+
+    if (slot == COMMAND_TRACKING_INVALID_SLOT) {
+        if (statUntracked > 0) {
+            statUntracked -= 1;
+        }
+    }
+    else if (slot < COMMAND_TRACKING_MAX_RECORDS && records[slot].inUse) {
+        CommandAllocationRecord& record = records[slot];
+        if (record.keyIndex != COMMAND_TRACKING_INVALID_SLOT) {
+            keyStats[record.keyIndex].stat.liveCount -= 1;
+        }
+        if (record.taskIndex != COMMAND_TRACKING_INVALID_SLOT) {
+            taskStats[record.taskIndex].stat.liveCount -= 1;
+        }
+        record.inUse = false;
+        freeSlots[numFreeSlots++] = slot;
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+}
+
+/**
+ * @brief Copies a live allocation record out of the table
+ * @param slot Record slot
+ * @param record Record to copy into
+ * @return true if the slot holds a live allocation
+*/
+bool CommandTracker::GetRecord(uint8_t slot, CommandAllocationRecord& record)
+{
+    if (slot >= COMMAND_TRACKING_MAX_RECORDS) {
+        return false;
+    }
+
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    record = records[slot];
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    return record.inUse;
+}
+
+/**
+ * @brief Prints the global, per GLOBAL_COMMANDS / taskCommand and per task allocation statistics through CUBE_PRINT
+*/
+void CommandTracker::PrintStats()
+{
+    CUBE_PRINT("CMD ALLOC live %d peak %d total %lu untracked %d\r\n",
+        statGlobal.liveCount, statGlobal.highWater, statGlobal.totalCount, statUntracked);
+
+    for (uint8_t i = 0; i < numKeys; i++) {
+        const KeyStat key = keyStats[i];
+        CUBE_PRINT("  cmd %d/%d live %d peak %d total %lu\r\n",
+            key.command, key.taskCommand, key.stat.liveCount, key.stat.highWater, key.stat.totalCount);
+    }
+
+    for (uint8_t i = 0; i < numTasks; i++) {
+        const TaskStat task = taskStats[i];
+        CUBE_PRINT("  task %s live %d peak %d total %lu\r\n",
+            (task.task != nullptr) ? pcTaskGetName(task.task) : "ISR/NONE",
+            task.stat.liveCount, task.stat.highWater, task.stat.totalCount);
+    }
+}
+
+/**
+ * @brief Prints every outstanding allocation older than the given age through CUBE_PRINT, these are leak candidates.
+ *        Records are copied one at a time, so allocations made by the prints themselves do not disturb the dump.
+ * @param minAgeMs Minimum age of an allocation to be printed
+ * @return Number of allocations printed
+*/
+uint16_t CommandTracker::DumpOutstanding(uint32_t minAgeMs)
+{
+    const uint32_t now = xTaskGetTickCount();
+    uint16_t numDumped = 0;
+
+    for (uint8_t slot = 0; slot < COMMAND_TRACKING_MAX_RECORDS; slot++) {
+        CommandAllocationRecord record;
+        if (!GetRecord(slot, record)) {
+            continue;
+        }
+
+        // Skip allocations made after the dump started (eg. by the dump's own prints)
+        const int32_t ageTicks = static_cast<int32_t>(now - record.allocTick);
+        if (ageTicks < 0) {
+            continue;
+        }
+
+        const uint32_t ageMs = TICKS_TO_MS(static_cast<uint32_t>(ageTicks));
+        if (ageMs < minAgeMs) {
+            continue;
+        }
+
+        CUBE_PRINT("CMD OUTSTANDING cmd %d/%d age %lu ms task %s site %p\r\n",
+            record.command, record.taskCommand, ageMs,
+            (record.task != nullptr) ? pcTaskGetName(record.task) : "ISR/NONE",
+            record.callSite);
+        numDumped++;
+    }
+
+    return numDumped;
+}
+
+/**
+ * @brief Finds the key statistics entry for a command pair, adding it if there is space. Must be called in a critical section.
+ * @return Index of the entry, COMMAND_TRACKING_INVALID_SLOT if the table is full
+*/
+uint8_t CommandTracker::FindOrAddKey(GLOBAL_COMMANDS command, uint16_t taskCommand)
+{
+    for (uint8_t i = 0; i < numKeys; i++) {
+        if (keyStats[i].command == command && keyStats[i].taskCommand == taskCommand) {
+            return i;
+        }
+    }
+
+    if (numKeys >= COMMAND_TRACKING_MAX_KEYS) {
+        return COMMAND_TRACKING_INVALID_SLOT;
+    }
+
+    keyStats[numKeys] = { command, taskCommand, {} };
+    return numKeys++;
+}
+
+/**
+ * @brief Finds the task statistics entry for a task, adding it if there is space. Must be called in a critical section.
+ * @return Index of the entry, COMMAND_TRACKING_INVALID_SLOT if the table is full
+*/
+uint8_t CommandTracker::FindOrAddTask(TaskHandle_t task)
+{
+    for (uint8_t i = 0; i < numTasks; i++) {
+        if (taskStats[i].task == task) {
+            return i;
+        }
+    }
+
+    if (numTasks >= COMMAND_TRACKING_MAX_TASKS) {
+        return COMMAND_TRACKING_INVALID_SLOT;
+    }
+
+    taskStats[numTasks] = { task, {} };
+    return numTasks++;
+}
+
+/**
+ * @brief Counts an allocation against a statistic and updates its high-water mark
+*/
+void CommandTracker::CountAllocation(CommandTrackingStat& stat)
+{
+    stat.liveCount += 1;
+    stat.totalCount += 1;
+    if (stat.liveCount > stat.highWater) {
+        stat.highWater = stat.liveCount;
+    }
+}
+
+#endif /* COMMAND_ALLOCATION_TRACKING */
@@ -0,0 +1,70 @@
+/**
+ ******************************************************************************
+ * File Name          : DeadlineQueue.cpp
+ * Description        : Implementation of the type independent DeadlineQueue core
+ ******************************************************************************
+*/
+#include "Core/Inc/DeadlineQueue.hpp"
+
+/* Function Implementation ------------------------------------------------------------------*/
+
+/**
+ * @brief Constructor for the DeadlineQueueCore class
+ * @param depth Depth of the deadline queue
+ * @param freeSlots Slot stack of depth entries, owned by the DeadlineQueue
+ * @param heapEntries Heap of depth entries, owned by the DeadlineQueue
+ * @param expiryPolicy What a receive does with items whose deadline has passed
+ * @param agingLimit_ms Max distance of the ordering key from the send time, 0 disables aging
+ */
+DeadlineQueueCore::DeadlineQueueCore(uint16_t depth, uint16_t* freeSlots, DeadlineHeap::Entry* heapEntries,
+                                     DeadlineExpiryPolicy expiryPolicy, uint32_t agingLimit_ms) :
+    PQueueCore(depth, freeSlots),
+    heap_(heapEntries)
+{
+    expiryPolicy_ = expiryPolicy;
+    agingLimitTicks_ = MS_TO_TICKS(agingLimit_ms);
+    expiredCount_ = 0;
+    droppedCount_ = 0;
+}
+
+/**
+ * Allocates a slot and pushes it to the heap, ordered by its deadline capped at the aging limit.
+ *
+ * @param now The send tick.
+ * @param deadline_ms The deadline relative to the send tick.
+ *
+ * @return The slot to store the item in.
+ */
+uint16_t DeadlineQueueCore::PushSlot(TickType_t now, uint32_t deadline_ms) {
+    const TickType_t deadlineTicks = MS_TO_TICKS(deadline_ms);
+    const TickType_t keyTicks = (agingLimitTicks_ != 0 && agingLimitTicks_ < deadlineTicks) ? agingLimitTicks_ : deadlineTicks;
+
+    const uint16_t slot = AllocateSlot();
+    heap_.Push({ now + keyTicks, now + deadlineTicks, 0, slot });
+    return slot;
+}
+
+/**
+ * Pops the slot with the earliest key and counts it if its deadline has passed.
+ *
+ * @param now The receive tick.
+ * @param slot Set to the popped slot, the caller frees it.
+ *
+ * @return true if the item must be delivered, false if it expired and must be dropped.
+ */
+bool DeadlineQueueCore::PopSlot(TickType_t now, uint16_t& slot) {
+    const DeadlineHeap::Entry entry = heap_.Pop();
+    slot = entry.slot_;
+
+    if(static_cast<std::make_signed_t<TickType_t>>(now - entry.deadline_) <= 0) {
+        return true;
+    }
+
+    expiredCount_ += 1;
+    if(expiryPolicy_ != DEADLINE_EXPIRED_DROP) {
+        return true;
+    }
+
+    droppedCount_ += 1;
+    return false;
+}
@@ -11,10 +11,33 @@
 #include <atomic>
 #include "cmsis_os.h"
 #include "SystemDefines.hpp"
+#include "CommandTracker.hpp"
+#include "CommandLatencyTracer.hpp"
+
+/* User Configurable Defines -------------------------------------------------*/
+// Inline payload size in bytes, payloads up to this size are stored inside the Command and travel by value
+// through queues instead of being allocated. 0 disables inline storage. Any size up to sizeof(uint8_t*) is
+// free as it shares storage with the data pointer, larger sizes grow every queue item by the difference.
+#ifndef COMMAND_INLINE_DATA_SIZE
+#define COMMAND_INLINE_DATA_SIZE 0
+#endif
+
+// Max number of segments in a scatter-gather (segmented) Command payload
+#ifndef COMMAND_MAX_SEGMENTS
+#define COMMAND_MAX_SEGMENTS 4
+#endif
 
 /* Macros --------------------------------------------------------------------*/
 
 /* Enums -----------------------------------------------------------------*/
+enum CommandDataMode : uint8_t {
+    COMMAND_DATA_NONE = 0,      // No data, or an unowned external buffer that has been reset
+    COMMAND_DATA_EXTERNAL,      // Data pointer refers to an external buffer, Command does not free it
+    COMMAND_DATA_ALLOCATED,     // Data pointer refers to memory owned by the Command (CommandPool / heap)
+    COMMAND_DATA_INLINE,        // Data is stored inline inside the Command object
+    COMMAND_DATA_SHARED,        // Data pointer refers to a reference counted block shared by several Commands
+    COMMAND_DATA_SEGMENTED,     // Data pointer refers to a list of segments owned by the Command, data is not contiguous
+};
 
 /* Class -----------------------------------------------------------------*/
 
@@ -23,7 +46,8 @@
  *
  * Each Command object contains one set of commands, a GLOBAL_COMMANDS and a task command that can be task specific.
  *
- * Note, this class must be able to be treated as 'Plain-Old-Data' as it will be handled with raw-copy in RTOS queues
+ * Note, this class must be able to be treated as 'Plain-Old-Data' as it will be handled with raw-copy in RTOS queues,
+ * data must always be accessed through GetDataPointer() as inline data moves with the object
 */
 class Command
 {
@@ -33,20 +57,40 @@ public:
     Command(uint16_t taskCommand);
     Command(GLOBAL_COMMANDS command, uint16_t taskCommand);
 
+    Command& operator=(const Command&) = default;    // Assignment copies the fields only, ownership of the data is not tracked (see Reset)
+
     //~Command();    // We can't handle memory like this, since the object would be 'destroyed' after copying to the RTOS queue
 
     // Functions
-    uint8_t* AllocateData(uint16_t dataSize);    // Dynamically allocates data for the command
+    uint8_t* AllocateData(uint16_t dataSize);    // Allocates data for the command, inline if it fits, otherwise dynamically
     bool CopyDataToCommand(uint8_t* dataSrc, uint16_t size);    // Copies the data into the command, into newly allocated memory
     bool SetCommandToStaticExternalBuffer(uint8_t* existingPtr, uint16_t size);    // Set data pointer to a pre-allocated buffer, if bFreeMemory is set to true, responsibility for freeing memory will fall on Command
 
+    uint8_t* AllocateSharedData(uint16_t dataSize);    // Allocates a reference counted data block that can be shared with other Commands
+    bool CopyDataToSharedCommand(uint8_t* dataSrc, uint16_t size);    // Copies the data into a newly allocated reference counted block
+    bool ShareDataWith(Command& target) const;    // Makes the (empty) target Command reference this Command's data without copying it
+    bool MakeShared();    // Converts exclusively owned data into a shared block, copies the payload once
+
+    bool AddSegment(uint8_t* segmentData, uint16_t size, bool takeOwnership = false);    // Appends a segment to a scatter-gather payload, owned segments must come from CommandPool::Allocate
+    uint8_t* AllocateSegment(uint16_t size);    // Allocates an owned segment and appends it to a scatter-gather payload
+    bool Flatten();    // Converts a scatter-gather payload into one contiguous allocated payload, for handlers that need contiguous data
+
     void Reset();    // Reset the command, equivalent of a destructor that must be called, counts allocations and deallocations, asserts an error if the allocation count is too high
 
     // Getters
     uint16_t GetDataSize() const;
-    uint8_t* GetDataPointer() const { return data; }
+    uint8_t* GetDataPointer() const;
+    uint16_t GetTotalDataSize() const;    // Data size including scatter-gather payloads
+    uint8_t GetSegmentCount() const;      // Number of segments, contiguous data counts as one segment
+    uint8_t* GetSegment(uint8_t index, uint16_t& size) const;
+    CommandDataMode GetDataMode() const { return dataMode; }
+    bool HasData() const { return dataMode == COMMAND_DATA_SEGMENTED || GetDataPointer() != nullptr; }
     GLOBAL_COMMANDS GetCommand() const { return command; }
     uint16_t GetTaskCommand() const { return taskCommand; }
+#ifdef COMMAND_LATENCY_TRACING
+    uint32_t GetEnqueueTimestamp() const { return enqueueTimestamp; }
+    uint16_t GetTraceId() const { return traceId; }    // 0 if the command has not been sent through a Queue
+#endif
 
     // Setters
     void SetTaskCommand(uint16_t taskCommand) { this->taskCommand = taskCommand; }
@@ -58,15 +102,51 @@ protected:
     GLOBAL_COMMANDS command;    // General GLOBAL command, each task must be able to handle these types of commands
     uint16_t taskCommand;        // Task specific command, the task this command event is sent to needs to handle this
 
-    uint8_t* data;                // Pointer to optional data
+    union {
+        uint8_t* data;            // Pointer to optional data
+#if COMMAND_INLINE_DATA_SIZE > 0
+        uint8_t inlineData[COMMAND_INLINE_DATA_SIZE];    // Inline optional data, valid in COMMAND_DATA_INLINE mode
+#endif
+    };
     uint16_t dataSize;            // Size of optional data
 
 private:
-    bool bShouldFreeData;        // Should the Command handle freeing the data pointer (necessary to enable Command object to handle static memory ptrs)
+    uint8_t* AllocateDataInternal(uint16_t dataSize, bool shared, const void* callSite);
+    void CountAllocation(const void* callSite);
+    void CountRelease();
+
+    CommandDataMode dataMode;    // How the data is stored, and if the Command handles freeing it (necessary to enable Command object to handle static memory ptrs)
+
+#ifdef COMMAND_ALLOCATION_TRACKING
+    uint8_t trackingSlot = COMMAND_TRACKING_INVALID_SLOT;    // CommandTracker record of the allocation, fits in existing padding
+#endif
+
+#ifdef COMMAND_LATENCY_TRACING
+    friend class CommandLatencyTracer;
+    uint32_t enqueueTimestamp = 0;    // COMMAND_LATENCY_TIMESTAMP() at the last send
+    uint16_t traceId = 0;             // Trace ID assigned at the last send
+#endif
 
     static std::atomic<uint16_t> statAllocationCounter;    // Static allocation counter shared by all command objects
 
     Command(const Command&);    // Prevent copy-construction
 };
 
+/**
+ * @brief Gets the pointer to the command data, resolves inline storage so it is always valid for this object
+ * @return Pointer to the data, nullptr if there is no data or the data is segmented (see GetSegment, Flatten)
+*/
+inline uint8_t* Command::GetDataPointer() const
+{
+#if COMMAND_INLINE_DATA_SIZE > 0
+    if (dataMode == COMMAND_DATA_INLINE) {
+        return const_cast<uint8_t*>(inlineData);
+    }
+#endif
+    if (dataMode == COMMAND_DATA_NONE || dataMode == COMMAND_DATA_SEGMENTED) {
+        return nullptr;
+    }
+    return data;
+}
+
 #endif /* CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_H */
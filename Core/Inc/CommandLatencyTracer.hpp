@@ -0,0 +1,124 @@
+/**
+ ******************************************************************************
+ * File Name          : CommandLatencyTracer.hpp
+ *
+ * Configuration      : Define macros in SystemDefines.hpp
+ *    #define COMMAND_LATENCY_TRACING - Enable Command latency tracing
+ *    #define COMMAND_LATENCY_TIMESTAMP() <expr> - High resolution uint32_t
+ *      counter, defaults to the DWT cycle counter
+ *    #define COMMAND_LATENCY_COUNTS_PER_US <expr> - Counter rate, defaults to
+ *      SystemCoreClock / 1000000
+ *    #define COMMAND_LATENCY_MAX_KEYS <int> - Max distinct task / taskCommand
+ *      pairs with histograms
+ *
+ * Description        :
+ *    When COMMAND_LATENCY_TRACING is defined every Command carries an enqueue
+ *    timestamp and a trace ID, both stamped by Queue when the Command is sent
+ *    (task or ISR). When the Command is received the queueing latency is
+ *    recorded, and when the task has finished handling it the end-to-end
+ *    latency is recorded (COMMAND_TRACE_HANDLED, called by the task loop).
+ *
+ *    Latencies are kept in per (receiving task, GLOBAL_COMMANDS, taskCommand)
+ *    log2 histograms in microseconds, bucket 0 is < 1us and bucket n holds
+ *    [2^(n-1), 2^n) us, the last bucket holds everything above. Histograms
+ *    are printed over the debug UART with PrintHistograms().
+ *
+ *    For Commands sent with a FromISR API the queueing latency is the
+ *    ISR-to-task wake latency. To compare against waking the task on the
+ *    next tick only, pass a pxHigherPriorityTaskWoken flag and discard it
+ *    instead of calling portYIELD_FROM_ISR.
+ *
+ *    CubeTask::InitTask starts the DWT cycle counter (Init), Commands sent
+ *    before the Cube task is initialized need an earlier call to Init.
+ *
+ *    When COMMAND_LATENCY_TRACING is not defined none of this is compiled,
+ *    the COMMAND_TRACE_* macros expand to nothing and the Command layout is
+ *    unchanged.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_LATENCY_TRACER_H
+#define CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_LATENCY_TRACER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "cmsis_os.h"
+#include "SystemDefines.hpp"
+
+/* User Configurable Defines -------------------------------------------------*/
+#ifndef COMMAND_LATENCY_TIMESTAMP // High resolution counter read
+#define COMMAND_LATENCY_TIMESTAMP() (DWT->CYCCNT)
+#define COMMAND_LATENCY_USE_DWT
+#endif
+#ifndef COMMAND_LATENCY_COUNTS_PER_US // Counter increments per microsecond
+#define COMMAND_LATENCY_COUNTS_PER_US (SystemCoreClock / 1000000U)
+#endif
+#ifndef COMMAND_LATENCY_MAX_KEYS // Max task / taskCommand pairs with histograms
+#define COMMAND_LATENCY_MAX_KEYS 16
+#endif
+
+/* Constants -----------------------------------------------------------------*/
+constexpr uint8_t COMMAND_LATENCY_NUM_BUCKETS = 16;    // < 1us up to >= 16.4ms
+
+/* Macros --------------------------------------------------------------------*/
+#ifdef COMMAND_LATENCY_TRACING
+#define COMMAND_TRACE_STAMP(cmd) CommandLatencyTracer::Stamp(cmd)
+#define COMMAND_TRACE_DEQUEUE(cmd) CommandLatencyTracer::RecordDequeue(cmd)
+#define COMMAND_TRACE_HANDLED(cmd) CommandLatencyTracer::RecordHandled(cmd)
+#else
+#define COMMAND_TRACE_STAMP(cmd) ((void)0)
+#define COMMAND_TRACE_DEQUEUE(cmd) ((void)0)
+#define COMMAND_TRACE_HANDLED(cmd) ((void)0)
+#endif
+
+#ifdef COMMAND_LATENCY_TRACING
+
+class Command;
+
+/* Class ---------------------------------------------------------------------*/
+
+/**
+ * @brief CommandLatencyTracer class, static queueing and end-to-end latency histograms for Commands
+*/
+class CommandLatencyTracer
+{
+public:
+    static void Init();    // Enables the DWT cycle counter if it is the timestamp source, called by CubeTask::InitTask
+
+    // Hooks called by Queue and task loops
+    static void Stamp(Command& cmd);                  // Stamps the enqueue time and a new trace ID
+    static void RecordDequeue(const Command& cmd);    // Records the time the command spent queued
+    static void RecordHandled(const Command& cmd);    // Records the time from enqueue to the end of the handler
+
+    // Reporting
+    static void PrintHistograms();
+    static void ClearHistograms();
+
+private:
+    struct LatencyHistogram {
+        uint16_t buckets[COMMAND_LATENCY_NUM_BUCKETS];    // Saturating counts
+        uint32_t maxUs;
+    };
+
+    struct LatencyKey {
+        TaskHandle_t task;
+        uint16_t taskCommand;
+        GLOBAL_COMMANDS command;
+        LatencyHistogram queued;       // Enqueue to dequeue
+        LatencyHistogram endToEnd;     // Enqueue to end of handler
+    };
+
+    static void Record(const Command& cmd, bool handled);
+    static void AddSample(LatencyHistogram& hist, uint32_t latencyUs);
+    static void PrintHistogram(const char* name, const LatencyHistogram& hist);
+    static uint8_t FindOrAddKey(TaskHandle_t task, GLOBAL_COMMANDS command, uint16_t taskCommand);
+
+    static LatencyKey keys[COMMAND_LATENCY_MAX_KEYS];
+    static uint8_t numKeys;
+    static uint16_t statDroppedSamples;    // Samples that could not get a key (table full)
+    static uint16_t traceIdCounter;
+
+    CommandLatencyTracer();    // Static only
+};
+
+#endif /* COMMAND_LATENCY_TRACING */
+
+#endif /* CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_LATENCY_TRACER_H */
@@ -0,0 +1,63 @@
+/**
+ ******************************************************************************
+ * File Name          : CommandLoan.hpp
+ * Description        :
+ *
+ *    CommandLoan lends a producer a writable Command payload buffer so the
+ *    payload can be built in place (eg. formatted with vsnprintf) and then
+ *    committed to a Queue as a Command, avoiding the stack buffer and the
+ *    copy done by Command::CopyDataToCommand.
+ *
+ *    The buffer is served like any other Command payload (inline, CommandPool
+ *    or heap fallback). A loan taken in an ISR has no heap fallback, it is
+ *    invalid if the pool cannot serve it, so check IsValid(). If the loan is never committed, or the commit fails,
+ *    the buffer is released automatically. A commit that uses less than the
+ *    buffer moves the payload into a smaller pool block when one fits, so a
+ *    loan can be sized for the longest payload.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_LOAN_H
+#define CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_LOAN_H
+/* Includes ------------------------------------------------------------------*/
+#include "Command.hpp"
+#include "Queue.hpp"
+
+/* Class -----------------------------------------------------------------*/
+
+/**
+ * @brief CommandLoan class, a scoped writable payload buffer that is committed to a Queue as a Command
+ *
+ * Example Usage:
+ *   CommandLoan loan(DATA_COMMAND, MY_TASK_COMMAND, MAX_SIZE);
+ *   uint16_t len = FormatInto(loan.GetBuffer(), loan.GetSize());
+ *   loan.Commit(*MyTask::Inst().GetEventQueue(), len);
+*/
+class CommandLoan
+{
+public:
+    CommandLoan(GLOBAL_COMMANDS command, uint16_t taskCommand, uint16_t size);
+    ~CommandLoan();    // Releases the buffer if it was not committed
+
+    // Functions
+    bool Commit(Queue& queue, uint16_t usedSize, bool reportFull = true);    // Sends the first usedSize bytes of the buffer as a Command
+    bool CommitFromISR(Queue& queue, uint16_t usedSize, BaseType_t* pxHigherPriorityTaskWoken = nullptr);    // Commit, safe to call from an ISR if the buffer was served from the pool or inline
+    void Release();    // Releases the buffer without sending it
+
+    // Getters
+    uint8_t* GetBuffer() const { return cmd.GetDataPointer(); }
+    uint16_t GetSize() const { return size; }
+    bool IsValid() const { return GetBuffer() != nullptr; }
+
+private:
+    bool PrepareCommit(uint16_t usedSize);
+    void Trim(uint16_t usedSize);    // Moves the used bytes into a smaller block if one fits
+    static uint16_t FittingBlockSize(uint16_t size);
+
+    Command cmd;      // Command holding the loaned buffer until it is committed
+    uint16_t size;    // Size of the loaned buffer
+
+    CommandLoan(const CommandLoan&);               // Prevent copy-construction
+    CommandLoan& operator=(const CommandLoan&);    // Prevent assignment
+};
+
+#endif /* CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_LOAN_H */
@@ -0,0 +1,140 @@
+/**
+ ******************************************************************************
+ * File Name          : CommandMailbox.hpp
+ *
+ * Configuration      : Define macros in SystemDefines.hpp
+ *    #define COMMAND_MAILBOX_DEFAULT_KEYS <int> - Default number of keys
+ *      (taskCommand values) a mailbox holds, max 32
+ *
+ * Description        :
+ *    CommandMailbox is a latest-value container for Commands, keyed by
+ *    taskCommand. It holds one slot per key, sending a Command whose key is
+ *    already pending replaces the pending Command and frees its payload, so
+ *    a slow receiver only ever sees the newest value of each key instead of
+ *    working through a backlog of stale ones. The first send of a key
+ *    claims a free slot, sends of new keys fail once every slot is claimed.
+ *
+ *    Receivers get the keys that changed since their last read, pending
+ *    keys are handed out round robin so a fast key cannot starve the
+ *    others. A binary semaphore is given while any key is pending, so a
+ *    receiver blocks on the mailbox like on a Queue, and the mailbox can be
+ *    registered as a Task event source (one receive per event).
+ *
+ *    Send and receive are O(keys) and safe to call from an ISR (FromISR
+ *    variants), the slots are updated in an interrupt mask critical section.
+ *
+ *    The slots and the semaphore are allocated by the constructor,
+ *    StaticCommandMailbox<NUM_KEYS> holds both in the object instead.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_MAILBOX_H
+#define CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_MAILBOX_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "cmsis_os.h"
+#include "SystemDefines.hpp"
+#include "Command.hpp"
+
+/* User Configurable Defines -------------------------------------------------*/
+#ifndef COMMAND_MAILBOX_DEFAULT_KEYS // Default number of keys (taskCommand values) in a mailbox
+#define COMMAND_MAILBOX_DEFAULT_KEYS 16
+#endif
+
+/* Constants -----------------------------------------------------------------*/
+constexpr uint8_t COMMAND_MAILBOX_MAX_KEYS = 32;    // Pending keys are tracked in a 32-bit mask
+
+static_assert(COMMAND_MAILBOX_DEFAULT_KEYS > 0 && COMMAND_MAILBOX_DEFAULT_KEYS <= COMMAND_MAILBOX_MAX_KEYS,
+              "CommandMailbox pending keys are tracked in a 32-bit mask");
+
+/* Class ---------------------------------------------------------------------*/
+
+/**
+ * @brief CommandMailbox class, latest value per taskCommand mailbox with RTOS signaling
+*/
+class CommandMailbox
+{
+public:
+    struct Slot {
+        Command command;         // Newest Command of the key, valid while the key is pending
+        uint16_t taskCommand;    // Key of the slot, valid for slots below numUsedKeys
+    };
+
+    // Constructors / Destructor
+    CommandMailbox(uint8_t numKeys = COMMAND_MAILBOX_DEFAULT_KEYS);
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    CommandMailbox(uint8_t numKeys, Slot* slots, StaticSemaphore_t* rtSemaphoreBuffer);    // Uses the given storage, see StaticCommandMailbox
+#endif
+    ~CommandMailbox();
+
+    // Send, replaces the pending Command of the same taskCommand
+    bool Send(Command& command, bool reportFull = true);
+    bool SendFromISR(Command& command, BaseType_t* pxHigherPriorityTaskWoken = nullptr);    // nullptr yields internally
+
+    // Receive the next changed key
+    bool Receive(Command& cm, uint32_t timeout_ms = 0);
+    bool ReceiveWait(Command& cm);
+    bool ReceiveFromISR(Command& cm, BaseType_t* pxHigherPriorityTaskWoken = nullptr);
+
+    // Receive every changed key (up to maxCount) at once
+    uint16_t ReceiveChanged(Command cms[], uint16_t maxCount, uint32_t timeout_ms = 0);
+    uint16_t ReceiveChangedWait(Command cms[], uint16_t maxCount);
+
+    void Clear();    // Drops every pending Command, keys stay claimed
+
+    // Getters
+    uint8_t GetNumKeys() const { return numKeys; }
+    uint8_t GetPendingCount() const { return static_cast<uint8_t>(__builtin_popcount(pendingMask)); }
+    bool IsPending(uint16_t taskCommand) const;
+    uint32_t GetReplacedCount() const { return statReplacedCounter; }    // Pending Commands replaced by a newer send
+    uint32_t GetRejectedCount() const { return statRejectedCounter; }    // Sends of new keys with every slot claimed
+    SemaphoreHandle_t GetRTOSHandle() const { return rtSemaphoreHandle; }
+
+private:
+    bool SendInternal(Command& command, BaseType_t* isrTaskWoken);
+    uint16_t ReceiveInternal(Command cms[], uint16_t maxCount, TickType_t waitTicks, BaseType_t* isrTaskWoken);
+    void FinishSignal(BaseType_t higherPriorityTaskWoken, BaseType_t* isrTaskWoken);
+    int16_t FindSlot(uint16_t taskCommand) const;
+
+    Slot* slots;
+    bool ownsSlots;           // The slots were allocated by the constructor
+    uint8_t numKeys;
+    uint8_t numUsedKeys;      // Slots below this index have been claimed by a key
+    uint8_t nextSlot;         // Round robin start of the next receive
+    uint32_t pendingMask;     // Bit per slot, set while the slot holds a Command that has not been received
+
+    SemaphoreHandle_t rtSemaphoreHandle;    // Given while pendingMask is not 0
+
+    uint32_t statReplacedCounter;
+    uint32_t statRejectedCounter;
+
+    CommandMailbox(const CommandMailbox&);    // Prevent copy-construction
+};
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+/**
+ * @brief Storage of a StaticCommandMailbox, a separate base class so it is constructed before the CommandMailbox that uses it
+*/
+template<uint8_t NUM_KEYS>
+class StaticCommandMailboxStorage {
+protected:
+    StaticSemaphore_t rtSemaphoreBuffer;           // RTOS semaphore control block
+    CommandMailbox::Slot slotStorage[NUM_KEYS];    // Key slots
+};
+
+/**
+ * @brief CommandMailbox with statically allocated slots and semaphore, sized by the template parameter
+*/
+template<uint8_t NUM_KEYS = COMMAND_MAILBOX_DEFAULT_KEYS>
+class StaticCommandMailbox : private StaticCommandMailboxStorage<NUM_KEYS>, public CommandMailbox {
+public:
+    static_assert(NUM_KEYS > 0 && NUM_KEYS <= COMMAND_MAILBOX_MAX_KEYS, "CommandMailbox pending keys are tracked in a 32-bit mask");
+
+    StaticCommandMailbox() : CommandMailbox(NUM_KEYS, this->slotStorage, &this->rtSemaphoreBuffer) {}
+
+private:
+    StaticCommandMailbox(const StaticCommandMailbox&);               // Prevent copy-construction, the RTOS semaphore refers to this object
+    StaticCommandMailbox& operator=(const StaticCommandMailbox&);    // Prevent assignment
+};
+#endif
+
+#endif /* CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_MAILBOX_H */
@@ -0,0 +1,102 @@
+/**
+ ******************************************************************************
+ * File Name          : CommandPool.hpp
+ *
+ * Configuration      : Define macros in SystemDefines.hpp
+ *    #define COMMAND_POOL_DISABLE - Disable the pool, all Command payloads
+ *      are allocated with cube_malloc
+ *    #define COMMAND_POOL_SMALL_BLOCK_SIZE <int> - Small block size in bytes
+ *    #define COMMAND_POOL_SMALL_BLOCK_COUNT <int> - Number of small blocks
+ *    #define COMMAND_POOL_MEDIUM_BLOCK_SIZE <int> - Medium block size in bytes
+ *    #define COMMAND_POOL_MEDIUM_BLOCK_COUNT <int> - Number of medium blocks
+ *    #define COMMAND_POOL_LARGE_BLOCK_SIZE <int> - Large block size in bytes
+ *    #define COMMAND_POOL_LARGE_BLOCK_COUNT <int> - Number of large blocks
+ *
+ * Description        :
+ *    CommandPool is the default backing store for Command payloads. It holds
+ *    three size classes of fixed blocks (ETL generic pools), a request is
+ *    served from the smallest class that fits and has a free block.
+ *
+ *    Allocate and Free are O(1) and are safe to call from an ISR as long as
+ *    the request is served by the pool. Requests that are larger than the
+ *    large block size, or that arrive when every fitting class is exhausted,
+ *    fall back to cube_malloc which is NOT safe to call from an ISR, so in an
+ *    ISR they fail and Allocate returns nullptr.
+ *
+ *    Free finds the owning class from the address of the block, so callers
+ *    do not need to remember which class (or the heap) a block came from.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_POOL_H
+#define CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_POOL_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <cstddef>
+#include "cmsis_os.h"
+#include "SystemDefines.hpp"
+
+/* User Configurable Defines -------------------------------------------------*/
+#ifndef COMMAND_POOL_SMALL_BLOCK_SIZE // Small blocks, sensor readings, states, IDs
+#define COMMAND_POOL_SMALL_BLOCK_SIZE 16
+#endif
+#ifndef COMMAND_POOL_SMALL_BLOCK_COUNT
+#define COMMAND_POOL_SMALL_BLOCK_COUNT 16
+#endif
+#ifndef COMMAND_POOL_MEDIUM_BLOCK_SIZE // Medium blocks, short packets and messages
+#define COMMAND_POOL_MEDIUM_BLOCK_SIZE 64
+#endif
+#ifndef COMMAND_POOL_MEDIUM_BLOCK_COUNT
+#define COMMAND_POOL_MEDIUM_BLOCK_COUNT 8
+#endif
+#ifndef COMMAND_POOL_LARGE_BLOCK_SIZE // Large blocks, sized for a full CUBE_PRINT buffer by default
+#define COMMAND_POOL_LARGE_BLOCK_SIZE DEBUG_PRINT_MAX_SIZE
+#endif
+#ifndef COMMAND_POOL_LARGE_BLOCK_COUNT
+#define COMMAND_POOL_LARGE_BLOCK_COUNT 6
+#endif
+
+/* Constants -----------------------------------------------------------------*/
+constexpr size_t COMMAND_POOL_BLOCK_ALIGNMENT = alignof(std::max_align_t); // Alignment of every pool block
+
+static_assert(COMMAND_POOL_SMALL_BLOCK_SIZE < COMMAND_POOL_MEDIUM_BLOCK_SIZE &&
+              COMMAND_POOL_MEDIUM_BLOCK_SIZE < COMMAND_POOL_LARGE_BLOCK_SIZE,
+              "CommandPool block sizes must be strictly increasing");
+
+/* Enums -----------------------------------------------------------------*/
+enum CommandPoolClass : uint8_t {
+    COMMAND_POOL_SMALL = 0,
+    COMMAND_POOL_MEDIUM,
+    COMMAND_POOL_LARGE,
+
+    COMMAND_POOL_NUM_CLASSES
+};
+
+/* Class -----------------------------------------------------------------*/
+
+/**
+ * @brief CommandPool class, size-class block allocator for Command payloads
+ *
+ * All members are static, there is exactly one pool for the system.
+*/
+class CommandPool
+{
+public:
+    static uint8_t* Allocate(uint16_t size);    // Allocates a block of at least size bytes
+    static void Free(uint8_t* ptr);             // Returns a block to its class, or to the heap
+
+    static bool IsPoolBlock(const uint8_t* ptr);    // True if the pointer was served by one of the pool classes
+
+    // Getters
+    static uint16_t GetBlockSize(CommandPoolClass poolClass);
+    static uint16_t GetAvailableBlocks(CommandPoolClass poolClass);
+    static uint16_t GetMinAvailableBlocks(CommandPoolClass poolClass) { return statMinAvailable[poolClass]; }
+    static uint16_t GetHeapFallbackCount() { return statHeapFallbackCounter; }
+
+private:
+    static uint16_t statMinAvailable[COMMAND_POOL_NUM_CLASSES];    // Lowest number of free blocks seen per class
+    static uint16_t statHeapFallbackCounter;                        // Number of allocations that fell back to cube_malloc
+
+    CommandPool();    // Static only
+};
+
+#endif /* CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_POOL_H */
@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ * File Name          : CommandSlotTable.hpp
+ *
+ * Configuration      : Define macros in SystemDefines.hpp
+ *    #define COMMAND_SLOT_TABLE_SIZE <int> - Number of Command slots, the max
+ *      number of Commands queued in handle mode Queues at any one time
+ *
+ * Description        :
+ *    CommandSlotTable is a global table of parked Command objects addressed
+ *    by 32-bit handles. A handle holds the slot index in the low 16 bits and
+ *    the slot generation in the high 16 bits. The generation is bumped when
+ *    a slot is stored to and again when it is released (odd generations are
+ *    live), so a stale or duplicated handle is detected instead of reading a
+ *    Command that has been reused.
+ *
+ *    Queues in QUEUE_ITEM_HANDLE mode park each Command here and only copy
+ *    the handle through the RTOS queue, so every queue entry costs 4 bytes
+ *    instead of sizeof(Command), and the Commands themselves only occupy RAM
+ *    while they are in flight. Store and Take are O(1) and safe to call from
+ *    an ISR.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_SLOT_TABLE_H
+#define CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_SLOT_TABLE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "cmsis_os.h"
+#include "SystemDefines.hpp"
+#include "Command.hpp"
+
+/* User Configurable Defines -------------------------------------------------*/
+#ifndef COMMAND_SLOT_TABLE_SIZE // Max Commands parked by handle mode Queues at any one time
+#define COMMAND_SLOT_TABLE_SIZE 32
+#endif
+
+static_assert(COMMAND_SLOT_TABLE_SIZE > 0 && COMMAND_SLOT_TABLE_SIZE < 0xFFFF, "CommandSlotTable indices are stored in 16 bits");
+
+/* Typedefs ------------------------------------------------------------------*/
+typedef uint32_t CommandHandle_t;    // Slot index (low 16 bits) and slot generation (high 16 bits)
+
+/* Constants -----------------------------------------------------------------*/
+constexpr CommandHandle_t COMMAND_HANDLE_INVALID = 0xFFFFFFFF;    // Never refers to a slot
+
+/* Class ---------------------------------------------------------------------*/
+
+/**
+ * @brief CommandSlotTable class, static generation checked table of Commands addressed by handles
+*/
+class CommandSlotTable
+{
+public:
+    static CommandHandle_t Store(Command& command);    // Parks a Command in a free slot, the Command is moved into the table
+    static bool Take(CommandHandle_t handle, Command& command);    // Moves a parked Command out of the table and frees the slot
+    static const Command* Peek(CommandHandle_t handle);    // Parked Command of a live handle, call in a critical section
+
+    // Getters
+    static uint16_t GetFreeSlots() { return numFreeSlots + (COMMAND_SLOT_TABLE_SIZE - numInitialisedSlots); }
+    static uint16_t GetMinFreeSlots() { return statMinFreeSlots; }
+    static uint16_t GetStaleHandleCount() { return statStaleHandleCounter; }
+
+    static uint16_t GetIndex(CommandHandle_t handle) { return static_cast<uint16_t>(handle & 0xFFFF); }
+    static uint16_t GetGeneration(CommandHandle_t handle) { return static_cast<uint16_t>(handle >> 16); }
+
+private:
+    static Command slots[COMMAND_SLOT_TABLE_SIZE];
+    static uint16_t generations[COMMAND_SLOT_TABLE_SIZE];    // Current generation of each slot, odd while the slot is in use
+    static uint16_t freeSlots[COMMAND_SLOT_TABLE_SIZE];      // Stack of released slot indices
+    static uint16_t numFreeSlots;
+    static uint16_t numInitialisedSlots;    // Slots below this index have been handed out at least once
+
+    static uint16_t statMinFreeSlots;          // Lowest number of free slots seen
+    static uint16_t statStaleHandleCounter;    // Number of Take calls with a stale or invalid handle
+
+    CommandSlotTable();    // Static only
+};
+
+#endif /* CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_SLOT_TABLE_H */
@@ -0,0 +1,147 @@
+/**
+ ******************************************************************************
+ * File Name          : CommandTracker.hpp
+ *
+ * Configuration      : Define macros in SystemDefines.hpp
+ *    #define COMMAND_ALLOCATION_TRACKING - Enable Command allocation tracking
+ *    #define COMMAND_TRACKING_MAX_RECORDS <int> - Max tracked live allocations
+ *      (max 254, defaults to MAX_NUMBER_OF_COMMAND_ALLOCATIONS)
+ *    #define COMMAND_TRACKING_MAX_KEYS <int> - Max distinct GLOBAL_COMMANDS /
+ *      taskCommand pairs with statistics
+ *    #define COMMAND_TRACKING_MAX_TASKS <int> - Max distinct tasks with statistics
+ *
+ * Description        :
+ *    CommandTracker records every live Command payload allocation (allocated
+ *    and shared data, inline and external data are not allocations) with the
+ *    allocating call site, task, tick and GLOBAL_COMMANDS / taskCommand pair.
+ *    Live counts and high-water marks are kept globally, per command pair and
+ *    per task, and outstanding allocations older than a threshold can be
+ *    dumped on demand to find leaks.
+ *
+ *    The record slot is stored in the Command (in existing padding), so
+ *    tracking an allocation and its release are O(1) apart from a short
+ *    bounded search of the key and task tables at allocation time. All
+ *    updates are done in an interrupt mask critical section so tracked
+ *    allocations remain safe to make from an ISR. ISR allocations are
+ *    attributed to no task.
+ *
+ *    When COMMAND_ALLOCATION_TRACKING is not defined, none of this is compiled
+ *    and the Command layout is unchanged.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_TRACKER_H
+#define CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_TRACKER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "cmsis_os.h"
+#include "SystemDefines.hpp"
+
+/* User Configurable Defines -------------------------------------------------*/
+#ifndef COMMAND_TRACKING_MAX_RECORDS // Max tracked live allocations
+#define COMMAND_TRACKING_MAX_RECORDS MAX_NUMBER_OF_COMMAND_ALLOCATIONS
+#endif
+#ifndef COMMAND_TRACKING_MAX_KEYS // Max GLOBAL_COMMANDS / taskCommand pairs with statistics
+#define COMMAND_TRACKING_MAX_KEYS 16
+#endif
+#ifndef COMMAND_TRACKING_MAX_TASKS // Max tasks with statistics
+#define COMMAND_TRACKING_MAX_TASKS 8
+#endif
+
+/* Constants -----------------------------------------------------------------*/
+constexpr uint8_t COMMAND_TRACKING_INVALID_SLOT = 0xFF; // Slot value of an untracked allocation
+
+/* Macros --------------------------------------------------------------------*/
+// Call site of the function using this macro, used to attribute allocations
+#ifdef COMMAND_ALLOCATION_TRACKING
+#define COMMAND_CALL_SITE() (__builtin_return_address(0))
+#else
+#define COMMAND_CALL_SITE() (nullptr)
+#endif
+
+#ifdef COMMAND_ALLOCATION_TRACKING
+
+static_assert(COMMAND_TRACKING_MAX_RECORDS < COMMAND_TRACKING_INVALID_SLOT, "CommandTracker slots are stored in a uint8_t");
+static_assert(COMMAND_TRACKING_MAX_KEYS < COMMAND_TRACKING_INVALID_SLOT && COMMAND_TRACKING_MAX_TASKS < COMMAND_TRACKING_INVALID_SLOT,
+              "CommandTracker table indices are stored in a uint8_t");
+
+/* Structs -------------------------------------------------------------------*/
+/**
+ * @brief Live count and high-water mark of a group of allocations
+*/
+struct CommandTrackingStat {
+    uint16_t liveCount;    // Allocations currently outstanding
+    uint16_t highWater;    // Highest liveCount seen
+    uint32_t totalCount;   // Allocations made since startup
+};
+
+/**
+ * @brief Record of one live allocation
+*/
+struct CommandAllocationRecord {
+    const void* callSite;      // Return address of the allocating call
+    TaskHandle_t task;         // Allocating task, nullptr if allocated from an ISR or before the scheduler started
+    uint32_t allocTick;        // Tick count at allocation
+    uint16_t taskCommand;      // taskCommand at allocation
+    GLOBAL_COMMANDS command;   // GLOBAL_COMMANDS at allocation
+    uint8_t keyIndex;          // Index into the key statistics table
+    uint8_t taskIndex;         // Index into the task statistics table
+    bool inUse;                // Record is in use
+};
+
+/* Class ---------------------------------------------------------------------*/
+
+/**
+ * @brief CommandTracker class, static allocation tracking for Command payloads
+*/
+class CommandTracker
+{
+public:
+    // Hooks called by Command
+    static uint8_t OnAllocate(GLOBAL_COMMANDS command, uint16_t taskCommand, const void* callSite);
+    static void OnRelease(uint8_t slot);
+
+    // Reporting
+    static void PrintStats();    // Prints global, per command pair and per task statistics
+    static uint16_t DumpOutstanding(uint32_t minAgeMs);    // Prints live allocations older than minAgeMs
+
+    // Getters
+    static uint16_t GetLiveCount() { return statGlobal.liveCount; }
+    static uint16_t GetHighWaterMark() { return statGlobal.highWater; }
+    static uint16_t GetUntrackedCount() { return statUntracked; }
+    static bool GetRecord(uint8_t slot, CommandAllocationRecord& record);
+
+private:
+    static uint8_t FindOrAddKey(GLOBAL_COMMANDS command, uint16_t taskCommand);
+    static uint8_t FindOrAddTask(TaskHandle_t task);
+    static void CountAllocation(CommandTrackingStat& stat);
+
+    struct KeyStat {
+        GLOBAL_COMMANDS command;
+        uint16_t taskCommand;
+        CommandTrackingStat stat;
+    };
+
+    struct TaskStat {
+        TaskHandle_t task;
+        CommandTrackingStat stat;
+    };
+
+    static CommandAllocationRecord records[COMMAND_TRACKING_MAX_RECORDS];
+    static uint8_t freeSlots[COMMAND_TRACKING_MAX_RECORDS];    // Stack of free record slots
+    static uint8_t numFreeSlots;
+    static uint8_t numInitialisedSlots;    // Slots below this index have been handed out at least once
+
+    static KeyStat keyStats[COMMAND_TRACKING_MAX_KEYS];
+    static uint8_t numKeys;
+    static TaskStat taskStats[COMMAND_TRACKING_MAX_TASKS];
+    static uint8_t numTasks;
+
+    static CommandTrackingStat statGlobal;
+    static uint16_t statUntracked;    // Allocations that could not get a record (table full)
+
+    CommandTracker();    // Static only
+};
+
+#endif /* COMMAND_ALLOCATION_TRACKING */
+
+#endif /* CUBE_PLUSPLUS_INCLUDE_CORE_COMMAND_TRACKER_H */
@@ -60,6 +60,18 @@ namespace Utils
     // Debug functionality
     int32_t ExtractIntParameter(const char* msg, uint16_t identifierLen);
 
+    // ISR context switch, finishes the higher priority task woken handling of a FromISR call. With a caller flag the
+    // woken state is accumulated into it for one portYIELD_FROM_ISR at the end of the ISR, with nullptr the context
+    // switch is requested here and runs as soon as the ISR exits.
+    inline void YieldFromISR(BaseType_t higherPriorityTaskWoken, BaseType_t* pxHigherPriorityTaskWoken) {
+        if (pxHigherPriorityTaskWoken != nullptr) {
+            if (higherPriorityTaskWoken == pdTRUE) *pxHigherPriorityTaskWoken = pdTRUE;
+        }
+        else {
+            portYIELD_FROM_ISR(higherPriorityTaskWoken);
+        }
+    }
+
 
 }
 
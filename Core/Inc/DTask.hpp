@@ -0,0 +1,31 @@
+/**
+ ******************************************************************************
+ * File Name          : DTask.hpp
+ * Description        : Deadline task contains the core component for all tasks,
+ *                      with an earliest-deadline-first event queue.
+ ******************************************************************************
+*/
+#ifndef CUBE_INCLUDE_CORE_DEADLINE_TASK_HPP
+#define CUBE_INCLUDE_CORE_DEADLINE_TASK_HPP
+/* Includes ------------------------------------------------------------------*/
+#include <cmsis_os.h>
+#include "DeadlineQueue.hpp"
+#include "EventQueueTask.hpp"
+#include "Command.hpp"
+#include "SystemDefines.hpp"
+
+/* Macros and Constants --------------------------------------------------*/
+constexpr uint16_t DEFAULT_DEADLINE_QUEUE_DEPTH = 10;
+
+/* Enums -----------------------------------------------------------------*/
+
+/* Class -----------------------------------------------------------------*/
+template<const size_t DEPTH = DEFAULT_DEADLINE_QUEUE_DEPTH>
+class DTask : public EventQueueTask<DeadlineQueue<Command, DEPTH>, uint32_t, DEADLINE_QUEUE_DEFAULT_DEADLINE_MS> {
+public:
+    //Constructors
+    DTask(DeadlineExpiryPolicy expiryPolicy = DEADLINE_EXPIRED_DELIVER, uint32_t agingLimit_ms = 0) :
+        EventQueueTask<DeadlineQueue<Command, DEPTH>, uint32_t, DEADLINE_QUEUE_DEFAULT_DEADLINE_MS>(expiryPolicy, agingLimit_ms) {}
+};
+
+#endif /* CUBE_INCLUDE_CORE_DEADLINE_TASK_HPP */
@@ -0,0 +1,278 @@
+/**
+ ******************************************************************************
+ * File Name          : DeadlineQueue.hpp
+ *
+ * Configuration      : Define macros in SystemDefines.hpp
+ *    #define DEADLINE_QUEUE_DEFAULT_DEADLINE_MS <int> - Relative deadline of
+ *      items sent without one
+ *
+ * Description        :
+ *    DeadlineQueue is an earliest-deadline-first (EDF) queue with RTOS
+ *    signaling, intended as a task event queue. Senders attach a deadline
+ *    relative to the send time, receivers always get the item with the
+ *    earliest absolute deadline, items with the same deadline are FIFO.
+ *
+ *    The aging limit (optional) is a cap on the ordering key, applied once at
+ *    send time: an item is ordered as if its deadline were at most
+ *    agingLimit_ms after it was sent, its real deadline is kept for expiry.
+ *    An item with a long or relaxed deadline is then ordered no later than
+ *    short deadline items sent agingLimit_ms after it. Nothing ages while
+ *    queued, the key is fixed at send time and the heap is never re-sorted.
+ *
+ *    Items whose deadline has passed when they are received are counted as
+ *    expired. With DEADLINE_EXPIRED_DROP they are dropped (a Command payload
+ *    is released) and the receive takes the next queued item without waiting,
+ *    so handlers never spend time on them. A receive that drops every queued
+ *    item returns false before its timeout. As event source of a task (queue
+ *    set), each dropped item leaves an event whose Receive returns false.
+ *
+ *    Storage, slot allocation and signaling are the same as PQueue (see
+ *    PQueueCore), absolute deadlines are tick counts compared with wrap-safe
+ *    arithmetic, so relative deadlines must be under half the tick range.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_INCLUDE_CORE_DEADLINE_QUEUE_H
+#define CUBE_PLUSPLUS_INCLUDE_CORE_DEADLINE_QUEUE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <type_traits>
+#include "cmsis_os.h"
+#include "PQueue.hpp"
+#include "Command.hpp"
+#include "SystemDefines.hpp"
+
+/* User Configurable Defines -------------------------------------------------*/
+#ifndef DEADLINE_QUEUE_DEFAULT_DEADLINE_MS // Relative deadline of items sent without one
+#define DEADLINE_QUEUE_DEFAULT_DEADLINE_MS 100
+#endif
+
+/* Enums -----------------------------------------------------------------*/
+enum DeadlineExpiryPolicy : uint8_t {
+    DEADLINE_EXPIRED_DELIVER = 0,    // Count expired items and deliver them (default)
+    DEADLINE_EXPIRED_DROP,           // Count expired items and drop them at receive, Command payloads are released
+};
+
+/* Class ---------------------------------------------------------------------*/
+/**
+ * @brief Heap entry of DeadlineQueue, ordered by key tick then FIFO by sequence number
+ */
+struct DeadlineHeapEntry {
+    TickType_t key_;         // Ordering tick, the deadline capped at the aging limit
+    TickType_t deadline_;    // Absolute deadline tick
+    seq_t order_;
+    uint16_t slot_;
+};
+
+struct DeadlineHeapBefore {
+    bool operator()(const DeadlineHeapEntry& a, const DeadlineHeapEntry& b) const {
+        if(a.key_ != b.key_) {
+            return static_cast<std::make_signed_t<TickType_t>>(a.key_ - b.key_) < 0;
+        }
+        return PQueueSlotHeap<DeadlineHeapEntry, DeadlineHeapBefore>::SeqBefore(a.order_, b.order_);
+    }
+};
+
+typedef PQueueSlotHeap<DeadlineHeapEntry, DeadlineHeapBefore> DeadlineHeap;
+
+/**
+ * @brief Type independent part of DeadlineQueue, deadline ordering and expiry accounting
+ */
+class DeadlineQueueCore : public PQueueCore {
+public:
+    // Getters
+    DeadlineExpiryPolicy GetExpiryPolicy() const { return expiryPolicy_; }
+    uint32_t GetExpiredCount() const { return expiredCount_; }    // Items received after their deadline, including dropped ones
+    uint32_t GetDroppedCount() const { return droppedCount_; }    // Expired items dropped by DEADLINE_EXPIRED_DROP
+
+protected:
+    DeadlineQueueCore(uint16_t depth, uint16_t* freeSlots, DeadlineHeap::Entry* heapEntries,
+                      DeadlineExpiryPolicy expiryPolicy, uint32_t agingLimit_ms);
+
+    // Must be called inside the critical section
+    uint16_t PushSlot(TickType_t now, uint32_t deadline_ms);    // Allocates a slot, there must be a free slot
+    bool PopSlot(TickType_t now, uint16_t& slot);               // Pops the earliest slot, false if it must be dropped
+
+    DeadlineHeap heap_;
+    DeadlineExpiryPolicy expiryPolicy_;
+    TickType_t agingLimitTicks_;    // 0 disables aging
+    uint32_t expiredCount_;
+    uint32_t droppedCount_;
+};
+
+/**
+ * @brief Deadline Queue Class
+ *
+ * @tparam T Object for the deadline queue
+ * @tparam SIZE Depth of the deadline queue in number of objects
+ */
+template<typename T, const size_t SIZE>
+class DeadlineQueue : public DeadlineQueueCore {
+public:
+    DeadlineQueue(DeadlineExpiryPolicy expiryPolicy = DEADLINE_EXPIRED_DELIVER, uint32_t agingLimit_ms = 0);
+
+    bool Send(PQueueItemRef<T> item, uint32_t deadline_ms = DEADLINE_QUEUE_DEFAULT_DEADLINE_MS);    // Deadline relative to now, a rejected Command is reset
+    bool SendFromISR(PQueueItemRef<T> item, uint32_t deadline_ms = DEADLINE_QUEUE_DEFAULT_DEADLINE_MS, BaseType_t* pxHigherPriorityTaskWoken = nullptr);    // nullptr yields internally
+    bool Receive(T& item, uint32_t timeout_ms = 0);
+    bool ReceiveWait(T& item);
+
+private:
+    static_assert(SIZE > 0 && SIZE <= UINT16_MAX, "DeadlineQueue SIZE must fit the 16-bit slot index");
+
+    bool ReceiveTicks(T& item, TickType_t waitTicks);
+
+    T items_[SIZE];
+    uint16_t slotStack_[SIZE];
+    DeadlineHeap::Entry heapEntries_[SIZE];
+};
+
+/* Functions ---------------------------------------------------------------------*/
+/**
+ * @brief Construct a new DeadlineQueue<T, SIZE>::DeadlineQueue object
+ *
+ * @param expiryPolicy What a receive does with items whose deadline has passed
+ * @param agingLimit_ms Cap on the ordering key, items are ordered as if their deadline were at most this far after the send,
+ *        0 (default) disables the cap
+ */
+template<typename T, const size_t SIZE>
+DeadlineQueue<T, SIZE>::DeadlineQueue(DeadlineExpiryPolicy expiryPolicy, uint32_t agingLimit_ms) :
+    DeadlineQueueCore(SIZE, slotStack_, heapEntries_, expiryPolicy, agingLimit_ms)
+ {
+    InitSlots();
+ }
+
+/**
+ * Sends an item with a deadline to the deadline queue.
+ *
+ * @param item The item to be sent to the deadline queue, a rejected Command is reset.
+ * @param deadline_ms The time from now the item must be handled within.
+ *
+ * @return True if the item was successfully sent, false if the queue is full.
+ */
+template<typename T, const size_t SIZE>
+bool DeadlineQueue<T, SIZE>::Send(PQueueItemRef<T> item, uint32_t deadline_ms) {
+    QUEUE_STATS_BEGIN();
+
+    const TickType_t now = xTaskGetTickCount();
+
+    // Store the item, if the queue is full we cannot do anything
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    const bool success = !IsFull();
+    if(success) {
+        items_[PushSlot(now, deadline_ms)] = item;
+    }
+    const uint16_t count = GetCurrentCount();
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    // Signal the consumer once the item is in the heap, a rejected Command is released
+    if(success) {
+        SignalItems(1);
+    }
+    else {
+        PQueueDrop(item);
+    }
+
+    QUEUE_STATS_SEND(success, count);
+    return success;
+}
+
+/**
+ * Sends an item with a deadline to the deadline queue, safe to call from ISR.
+ *
+ * @param item The item to be sent to the deadline queue, a rejected Command is reset.
+ * @param deadline_ms The time from now the item must be handled within.
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the send woke a higher priority task, the caller must then call
+ *        portYIELD_FROM_ISR before the ISR exits. If nullptr (default), the context switch is requested internally.
+ *
+ * @return True if the item was successfully sent, false if the queue is full.
+ */
+template<typename T, const size_t SIZE>
+bool DeadlineQueue<T, SIZE>::SendFromISR(PQueueItemRef<T> item, uint32_t deadline_ms, BaseType_t* pxHigherPriorityTaskWoken) {
+    const TickType_t now = xTaskGetTickCountFromISR();
+
+    // Store the item, if the queue is full we cannot do anything
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    const bool success = !IsFull();
+    if(success) {
+        items_[PushSlot(now, deadline_ms)] = item;
+    }
+    const uint16_t count = GetCurrentCount();
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    // Signal the consumer once the item is in the heap, a rejected Command is released
+    if(success) {
+        SignalItemFromISR(pxHigherPriorityTaskWoken);
+    }
+    else {
+        PQueueDrop(item);
+    }
+
+    QUEUE_STATS_SEND_NO_WAIT(success, count);
+    return success;
+}
+
+/**
+ * Receives the item with the earliest deadline from the deadline queue.
+ *
+ * @param item the item to be received into from the deadline queue
+ * @param timeout_ms the timeout in milliseconds to wait for an item to be available in the queue
+ *
+ * @return true if an item was successfully received, false otherwise
+ */
+template<typename T, const size_t SIZE>
+bool DeadlineQueue<T, SIZE>::Receive(T& item, uint32_t timeout_ms) {
+    return ReceiveTicks(item, MS_TO_TICKS(timeout_ms));
+}
+
+/**
+ * Wait forever for an item to be available in the deadline queue.
+ *
+ * @param item the item to be received into from the deadline queue
+ *
+ * @return true if the item was successfully received, false otherwise
+ */
+template<typename T, const size_t SIZE>
+bool DeadlineQueue<T, SIZE>::ReceiveWait(T& item) {
+    return ReceiveTicks(item, HAL_MAX_DELAY);
+}
+
+/**
+ * Waits for an item to be signaled and takes the item with the earliest deadline. Expired items are
+ * dropped with DEADLINE_EXPIRED_DROP and the next queued item is taken without waiting, so one receive
+ * only blocks for the first item and returns false if every queued item was dropped.
+ *
+ * @param item the item to be received into from the deadline queue
+ * @param waitTicks the ticks to wait for an item to be available in the queue
+ *
+ * @return true if an item was successfully received, false otherwise
+ */
+template<typename T, const size_t SIZE>
+bool DeadlineQueue<T, SIZE>::ReceiveTicks(T& item, TickType_t waitTicks) {
+    QUEUE_STATS_BEGIN();
+
+    // Every semaphore count matches an item in the heap
+    while(WaitItem(waitTicks)) {
+        const TickType_t now = xTaskGetTickCount();
+
+        UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+        uint16_t slot;
+        const bool deliver = PopSlot(now, slot);
+        item = items_[slot];
+        FreeSlot(slot);
+        taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+        if(deliver) {
+            QUEUE_STATS_RECEIVE(true);
+            return true;
+        }
+
+        // Only take items that are already queued after a drop, a blocking wait here would take counts of
+        // items sent later, which the caller (eg. a queue set handler) expects to receive one by one
+        PQueueDrop(item);
+        waitTicks = 0;
+    }
+
+    QUEUE_STATS_RECEIVE(false);
+    return false;
+}
+
+#endif // CUBE_PLUSPLUS_INCLUDE_CORE_DEADLINE_QUEUE_H
@@ -0,0 +1,53 @@
+/**
+ ******************************************************************************
+ * File Name          : EventQueueTask.hpp
+ * Description        : Common base of PTask and DTask, a task with an event
+ *                      queue of Commands held inside the task object.
+ ******************************************************************************
+*/
+#ifndef CUBE_INCLUDE_CORE_EVENT_QUEUE_TASK_HPP
+#define CUBE_INCLUDE_CORE_EVENT_QUEUE_TASK_HPP
+/* Includes ------------------------------------------------------------------*/
+#include <cmsis_os.h>
+#include "Command.hpp"
+#include "SystemDefines.hpp"
+
+/* Class -----------------------------------------------------------------*/
+/**
+ * @brief Task with an embedded event queue
+ *
+ * @tparam QUEUE Event queue type, PQueue<Command, ...> or DeadlineQueue<Command, ...>
+ * @tparam KEY Ordering argument of QUEUE::Send (priority or relative deadline)
+ * @tparam DEFAULT_KEY Ordering argument of commands sent without one
+ */
+template<typename QUEUE, typename KEY, KEY DEFAULT_KEY>
+class EventQueueTask {
+public:
+    virtual void InitTask() = 0;
+
+    QUEUE* GetEventQueue() const { return qEvtQueue_; }
+    // A command the event queue rejects is reset by the queue, its payload is released
+    void SendCommand(Command cmd, KEY key = DEFAULT_KEY) { qEvtQueue_->Send(cmd, key); }
+    void SendCommandReference(Command& cmd, KEY key = DEFAULT_KEY) { qEvtQueue_->Send(cmd, key); }
+
+protected:
+    //Constructors
+    template<typename... ARGS>
+    EventQueueTask(ARGS... queueArgs) : qEvtQueue_(&evtQueue_), evtQueue_(queueArgs...) {
+        rtTaskHandle_ = nullptr;
+    }
+
+    //RTOS
+    TaskHandle_t rtTaskHandle_;   // RTOS Task Handle
+
+    //Task structures
+    QUEUE* qEvtQueue_;    // Task event queue
+
+private:
+    QUEUE evtQueue_;    // Event queue storage, part of the task object so no heap is used
+
+    EventQueueTask(const EventQueueTask&);               // Prevent copy-construction, qEvtQueue_ points into this object
+    EventQueueTask& operator=(const EventQueueTask&);    // Prevent assignment
+};
+
+#endif /* CUBE_INCLUDE_CORE_EVENT_QUEUE_TASK_HPP */
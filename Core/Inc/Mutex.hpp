@@ -23,19 +23,50 @@ class Mutex
 public:
     // Constructors / Destructor
     Mutex();
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    Mutex(StaticSemaphore_t* rtSemaphoreBuffer);    // Creates the mutex in the given storage, see StaticMutex
+#endif
     ~Mutex();
 
     // Public functions
     bool Lock(uint32_t timeout_ms = portMAX_DELAY);
     bool Unlock();
 
-    bool LockFromISR();
-    bool UnlockFromISR();
+    // FromISR, pass a flag to defer the context switch to one portYIELD_FROM_ISR at the end of the ISR
+    bool LockFromISR(BaseType_t* pxHigherPriorityTaskWoken = nullptr);
+    bool UnlockFromISR(BaseType_t* pxHigherPriorityTaskWoken = nullptr);
+
+    // Getters
+    SemaphoreHandle_t GetRTOSHandle() const { return rtSemaphoreHandle; }
 
 private:
     SemaphoreHandle_t rtSemaphoreHandle;
 
 };
 
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+/**
+ * @brief Storage of a StaticMutex, a separate base class so it is constructed before the Mutex that uses it
+ */
+class StaticMutexStorage
+{
+protected:
+    StaticSemaphore_t rtSemaphoreBuffer;    // RTOS semaphore control block
+};
+
+/**
+ * @brief Mutex with a statically allocated RTOS semaphore
+ */
+class StaticMutex : private StaticMutexStorage, public Mutex
+{
+public:
+    StaticMutex() : Mutex(&this->rtSemaphoreBuffer) {}
+
+private:
+    StaticMutex(const StaticMutex&);               // Prevent copy-construction
+    StaticMutex& operator=(const StaticMutex&);    // Prevent assignment
+};
+#endif
+
 
 #endif /* CUBE_PLUSPLUS_INCLUDE_CORE_MUTEX_H */
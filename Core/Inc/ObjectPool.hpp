@@ -0,0 +1,165 @@
+/**
+ ******************************************************************************
+ * File Name          : ObjectPool.hpp
+ * Description        :
+ *
+ *    ObjectPool<T, SIZE> is a fixed pool of SIZE objects of type T (ETL
+ *    generic pool), and PoolPtr<T> is the move-only owner of one object
+ *    acquired from it. The object is destroyed and its block returned to the
+ *    pool when the owner is reset or destroyed, so an object always has
+ *    exactly one owner and cannot leak or be released twice.
+ *
+ *    Acquire and release are O(1) and safe to call from an ISR, the free list
+ *    update runs inside an interrupt mask critical section (same as
+ *    CommandPool). The destructor of T runs outside the critical section.
+ *
+ *    Objects are passed between tasks by pointer with PoolQueue<T>.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_INCLUDE_CORE_OBJECT_POOL_H
+#define CUBE_PLUSPLUS_INCLUDE_CORE_OBJECT_POOL_H
+/* Includes ------------------------------------------------------------------*/
+#include <new>
+#include <utility>
+#include "etl/generic_pool.h"
+#include "cmsis_os.h"
+
+template<typename T> class PoolQueue;
+
+/* Class -----------------------------------------------------------------*/
+
+/**
+ * @brief Size independent interface of ObjectPool<T, SIZE>, used by owners to return objects
+*/
+template<typename T>
+class ObjectPoolBase {
+public:
+    virtual void Release(T* object) = 0;    // Destroys the object and returns its block to the pool
+
+protected:
+    ~ObjectPoolBase() {}
+};
+
+/**
+ * @brief PoolPtr class, move-only owner of an object acquired from an ObjectPool
+ *
+ * Example Usage:
+ *   PoolPtr<ImuFrame> frame = imuPool.Acquire();
+ *   if (frame) { frame->accel = ...; imuQueue.Send(std::move(frame)); }
+ *
+ *   PoolPtr<ImuFrame> rx;
+ *   if (imuQueue.ReceiveWait(rx)) Process(*rx);    // Returned to the pool when rx is reused or destroyed
+*/
+template<typename T>
+class PoolPtr {
+public:
+    PoolPtr() : object(nullptr), pool(nullptr) {}
+    PoolPtr(PoolPtr&& other) : object(other.object), pool(other.pool) { other.Disown(); }
+    PoolPtr& operator=(PoolPtr&& other) {
+        if (this != &other) {
+            Reset();
+            object = other.object;
+            pool = other.pool;
+            other.Disown();
+        }
+        return *this;
+    }
+    ~PoolPtr() { Reset(); }
+
+    // Functions
+    void Reset() {    // Returns the object to its pool, leaves an empty owner
+        if (object != nullptr)
+            pool->Release(object);
+        Disown();
+    }
+
+    // Accessors
+    T* Get() const { return object; }
+    T* operator->() const { return object; }
+    T& operator*() const { return *object; }
+    explicit operator bool() const { return object != nullptr; }
+    ObjectPoolBase<T>* GetPool() const { return pool; }
+
+private:
+    template<typename U, const size_t SIZE> friend class ObjectPool;
+    friend class PoolQueue<T>;
+
+    PoolPtr(T* object, ObjectPoolBase<T>* pool) : object(object), pool(pool) {}
+    T* Disown() {    // Forgets the object without releasing it, ownership has moved elsewhere
+        T* owned = object;
+        object = nullptr;
+        pool = nullptr;
+        return owned;
+    }
+
+    T* object;                  // Owned object, nullptr if empty
+    ObjectPoolBase<T>* pool;    // Pool the object came from
+
+    PoolPtr(const PoolPtr&);               // Prevent copy-construction
+    PoolPtr& operator=(const PoolPtr&);    // Prevent assignment
+};
+
+/**
+ * @brief ObjectPool class, fixed pool of SIZE objects of type T handed out as PoolPtr owners
+*/
+template<typename T, const size_t SIZE>
+class ObjectPool : public ObjectPoolBase<T> {
+public:
+    ObjectPool() : minAvailable(SIZE) {}
+
+    template<typename... Args>
+    PoolPtr<T> Acquire(Args&&... args);    // Constructs an object in a free block, empty owner if the pool is exhausted
+    void Release(T* object) override;
+
+    // Getters
+    uint16_t GetAvailable() const { return static_cast<uint16_t>(pool.available()); }
+    uint16_t GetMinAvailable() const { return minAvailable; }
+    static constexpr size_t GetSize() { return SIZE; }
+
+private:
+    etl::generic_pool<sizeof(T), alignof(T), SIZE> pool;
+    uint16_t minAvailable;    // Lowest number of free objects seen
+
+    ObjectPool(const ObjectPool&);               // Prevent copy-construction
+    ObjectPool& operator=(const ObjectPool&);    // Prevent assignment
+};
+
+/**
+ * @brief Acquires a free block and constructs an object in it, safe to call from an ISR if T's constructor is
+ * @param args Arguments forwarded to the constructor of T
+ * @return Owner of the new object, empty (false) if the pool is exhausted
+*/
+template<typename T, const size_t SIZE>
+template<typename... Args>
+PoolPtr<T> ObjectPool<T, SIZE>::Acquire(Args&&... args)
+{
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    void* block = nullptr;
+    if (!pool.full()) {
+        block = pool.template allocate<T>();
+        if (pool.available() < minAvailable)
+            minAvailable = static_cast<uint16_t>(pool.available());
+    }
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    if (block == nullptr)
+        return PoolPtr<T>();
+
+    return PoolPtr<T>(::new (block) T(std::forward<Args>(args)...), this);
+}
+
+/**
+ * @brief Destroys an object and returns its block to the pool, called by PoolPtr
+ * @param object Object acquired from this pool
+*/
+template<typename T, const size_t SIZE>
+void ObjectPool<T, SIZE>::Release(T* object)
+{
+    object->~T();
+
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    pool.release(object);
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+}
+
+#endif /* CUBE_PLUSPLUS_INCLUDE_CORE_OBJECT_POOL_H */
@@ -1,52 +1,80 @@
 /**
  ******************************************************************************
  * File Name          : PQueue.hpp
- * 
+ *
  * Configuration      : Define macros in SystemDefines.hpp
- *    #define PQUEUE_ERROR_COUNT_MAX <int> - Max errors before assert
  *    #define PQUEUE_SEQN_TYPE <type> - Sequence number type
- *    #define PQUEUE_DISABLE_SEQN_CIRCULAR_CHECK - Disable 
- *      sequence number circular check, saves +4/8B (pointer size) overhead
- *      per item, but reduces protection against sequence number wrap-around
- * 
+ *
  * Description        :
- *    PQueue is a wrapper for FreeRTOS Queues and ETL Priority Queues to
- *    allow proper signaling within FreeRTOS
- * 
- *    This priority queue is intended to be used for task event signaling and
- *    prioritization and maintains FIFO ordering within each priority level.
- * 
- *    If FIFO ordering and RTOS signaling is not required, consider using the
- *    ETL priority queue directly.
- * 
- *    Note: In order to maintain FIFO ordering, a sequence number is used in 
- *    each queue item. Note that the sequence number will wrap around. This is
- *    handled by the comparison operator in the PriorityQueueItem struct,
- *    however it assumes that the sequence number will not wrap around twice
- *    before all items in the previous wrap-around have been received from 
- *    the queue. By default a 16-bit sequence number is used, which should
- *    be a reasonable trade-off for most applications. The sequence number type
- *    can be configured by defining PQUEUE_SEQN_TYPE in SystemDefines
- * 
- * Future Improvements :
- *   - Implementing the priority queue directly (not ETL) would allow the sequence
- *   number check to be integrated into the class itself, removing the per-item
- *   overhead of the sequence number pointer.
+ *    PQueue is a priority queue with RTOS signaling, intended for task event
+ *    signaling and prioritization. It maintains FIFO ordering within each
+ *    priority level.
+ *
+ *    The queue owns its item storage and an ordering structure of slot indices,
+ *    selected with the ORDER template policy:
+ *      - PQueueHeapOrder (default), binary heap, O(log n) push / pop, FIFO
+ *        within a level by sequence number, 6 bytes per slot
+ *      - PQueueBucketOrder, one FIFO bucket per priority level and a 256-bit
+ *        occupancy bitmap searched with CLZ, O(1) push / pop and no sequence
+ *        numbers, 2 bytes per slot plus ~550 bytes per queue
+ *
+ *    Items are stored and taken under a short interrupt mask critical section, so
+ *    SendFromISR can push from an interrupt directly, and
+ *    the consumer is signaled with a counting semaphore that holds one count
+ *    per item. A count is only given after its item is in the ordering and each
+ *    receive takes one count before popping, so the ordering is never empty
+ *    when a receiver holds a count. With configSUPPORT_STATIC_ALLOCATION the
+ *    semaphore is created in the queue object, so a PQueue does not use the
+ *    RTOS heap at all.
+ *
+ *    Capacity reservation (optional) partitions the slots between priority
+ *    bands with a compile-time table, selected with the RESERVATION template
+ *    policy, so a flood of low priority items cannot take the slots kept for
+ *    higher priorities. Each table entry reserves slots that only priorities
+ *    at or above its minPriority may take, entries are ordered from the
+ *    highest minPriority down:
+ *
+ *      struct EventReservation {
+ *          static constexpr PQueueBand BANDS[] = { {Priority::HIGH, 2}, {Priority::NORMAL, 4} };
+ *      };
+ *      PQueue<Command, 16, PQueueHeapOrder, EventReservation> q;
+ *
+ *    Here HIGH and above may use all 16 slots, NORMAL up to HIGH 14 and
+ *    anything below NORMAL 10. The band and slot limit of each priority are
+ *    precomputed in a 256-entry table at compile time (~256 bytes of flash per
+ *    table), so admission is one lookup and compare. Rejected sends are
+ *    counted per band. A rejected Command is reset, as with Queue::Send,
+ *    the UniqueCommand overloads leave it with the caller instead.
+ *
+ *    Note: In order to maintain FIFO ordering, the heap stores a sequence number in
+ *    each entry. The sequence number wraps around, entries are compared
+ *    with serial number arithmetic (the difference of the two numbers as a
+ *    signed value), which is correct as long as two queued items of the same
+ *    priority are less than half the sequence number range apart. The
+ *    sequence number restarts whenever the queue is empty. By default a
+ *    16-bit sequence number is used, which should be a reasonable trade-off
+ *    for most applications. The sequence number type can be configured by
+ *    defining PQUEUE_SEQN_TYPE in SystemDefines
+ *
+ *    The RTOS signaling, slot allocation and orderings are implemented once in
+ *    classes that do not depend on the item type (the binary heap,
+ *    PQueueSlotHeap, is shared with DeadlineQueue), PQueue<T, SIZE, ORDER>
+ *    only holds the typed item storage.
  ******************************************************************************
 */
 #ifndef CUBE_PLUSPLUS_INCLUDE_PRIORITY_QUEUE_H
 #define CUBE_PLUSPLUS_INCLUDE_PRIORITY_QUEUE_H
 
 /* Includes ------------------------------------------------------------------*/
-#include "etl/priority_queue.h"
-#include "TQueue.hpp"
-#include "Mutex.hpp"
+#include <type_traits>
+#include "cmsis_os.h"
+#include "semphr.h"
+#include "QueueStats.hpp"
+#include "UniqueCommand.hpp"
 #include "CubeDefines.hpp"
 #include "SystemDefines.hpp"
 
 /* Constants and Definitions -------------------------------------------------*/
-constexpr uint32_t PQUEUE_MTX_TIMEOUT_MS = 250; // Mutex Timeout
-constexpr uint8_t RTQUEUE_ITEM = 1; // RTOS Queue Holder Item
 enum Priority : uint8_t {
     HIGH = 200,   // 200 so +- ~50 for fine adjustment
     NORMAL = 127, // 127 centered
@@ -57,141 +85,500 @@ enum Priority : uint8_t {
 };
 
 /* User Configurable Defines -------------------------------------------------*/
-#ifndef PQUEUE_ERROR_COUNT_MAX // Maximum number of errors before assert
-#define PQUEUE_ERROR_COUNT_MAX 10
-#endif
 #ifndef PQUEUE_SEQN_TYPE // Sequence number type
 #define PQUEUE_SEQN_TYPE uint16_t
 #endif
-#ifndef PQUEUE_DISABLE_SEQN_CIRCULAR_CHECK // Disable sequence number circular check 
-#define PQUEUE_ENABLE_SEQN_CIRCULAR_CHECK // (uses +4/8B (pointer size) overhead per item)
-#endif
 
 /* Macros --------------------------------------------------------------------*/
 typedef PQUEUE_SEQN_TYPE seq_t;
 
+static_assert(std::is_unsigned<seq_t>::value, "PQUEUE_SEQN_TYPE must be an unsigned integer type");
+
 /* Class ---------------------------------------------------------------------*/
+/**
+ * @brief Binary heap of queue slot indices, shared by PQueue and DeadlineQueue. ENTRY holds the ordering key,
+ *        a seq_t order_ and a uint16_t slot_, BEFORE(a, b) is true if a must be popped before b and compares
+ *        order_ with SeqBefore for entries with the same key. Not thread safe, the queues call it inside
+ *        their critical section.
+ */
+template<typename ENTRY, typename BEFORE>
+class PQueueSlotHeap {
+public:
+    typedef ENTRY Entry;
+
+    PQueueSlotHeap(Entry* entries) : heap_(entries), size_(0), seqN_(0) {}
+
+    void Push(Entry entry);    // Sets the sequence number of the entry, the heap must have room for it
+    Entry Pop();               // First entry by BEFORE, the heap must not be empty
+
+    uint16_t GetSize() const { return size_; }
+
+    // Serial number comparison, a was pushed before b if the wrapped difference is negative
+    static bool SeqBefore(seq_t a, seq_t b) {
+        return static_cast<std::make_signed_t<seq_t>>(static_cast<seq_t>(a - b)) < 0;
+    }
+
+private:
+    Entry* heap_;
+    uint16_t size_;
+    seq_t seqN_;
+};
+
+/**
+ * @brief Heap entry of PQueue, ordered by priority then FIFO by sequence number
+ */
+struct PQueueHeapEntry {
+    uint8_t priority_;
+    seq_t order_;
+    uint16_t slot_;
+};
+
+struct PQueueHeapBefore {
+    bool operator()(const PQueueHeapEntry& a, const PQueueHeapEntry& b) const {
+        if(a.priority_ != b.priority_) {
+            return a.priority_ > b.priority_;
+        }
+        return PQueueSlotHeap<PQueueHeapEntry, PQueueHeapBefore>::SeqBefore(a.order_, b.order_);
+    }
+};
+
+/**
+ * @brief Binary heap of PQueue slot indices, ordered by priority then FIFO by sequence number
+ */
+class PQueueHeap : public PQueueSlotHeap<PQueueHeapEntry, PQueueHeapBefore> {
+public:
+    PQueueHeap(Entry* entries) : PQueueSlotHeap(entries) {}
+
+    void Push(uint16_t slot, uint8_t priority) { PQueueSlotHeap::Push({ priority, 0, slot }); }
+    uint16_t Pop() { return PQueueSlotHeap::Pop().slot_; }    // Slot of the highest priority, oldest entry, the heap must not be empty
+};
+
+/**
+ * @brief Heap ordering policy of PQueue, holds the heap entries of SIZE slots
+ */
+template<size_t SIZE>
+class PQueueHeapOrder : public PQueueHeap {
+public:
+    PQueueHeapOrder() : PQueueHeap(entries_) {}
+
+private:
+    Entry entries_[SIZE];
+};
+
+/**
+ * @brief Per-priority FIFO buckets of PQueue slot indices with an occupancy bitmap, push and pop are O(1).
+ *        Each bucket is a circular singly linked list through the slots, only the tail is stored and the
+ *        head is the slot after it. Not thread safe, PQueue calls it inside its critical section.
+ */
+class PQueueBuckets {
+public:
+    PQueueBuckets(uint16_t* next) : next_(next), size_(0), summary_(0), bitmap_() {}
+
+    void Push(uint16_t slot, uint8_t priority);
+    uint16_t Pop();    // Oldest slot of the highest occupied priority, the buckets must not be empty
+
+    uint16_t GetSize() const { return size_; }
+
+private:
+    static constexpr uint8_t NUM_WORDS = 8;    // 256 priority levels in 32-bit bitmap words
+
+    uint16_t* next_;           // Next slot in the bucket of each slot
+    uint16_t size_;
+    uint8_t summary_;          // Bit per bitmap word, set while the word is not 0
+    uint32_t bitmap_[NUM_WORDS];    // Bit per priority, set while the bucket is not empty
+    uint16_t tails_[256];      // Newest slot of each occupied bucket
+};
+
+/**
+ * @brief Bucket ordering policy of PQueue, holds the bucket links of SIZE slots
+ */
+template<size_t SIZE>
+class PQueueBucketOrder : public PQueueBuckets {
+public:
+    PQueueBucketOrder() : PQueueBuckets(next_) {}
+
+private:
+    uint16_t next_[SIZE];
+};
+
+/**
+ * @brief Priority band of a PQueue capacity reservation table
+ */
+struct PQueueBand {
+    uint8_t minPriority;    // Lowest priority of the band
+    uint16_t reserved;      // Slots that only priorities at or above minPriority may take
+};
+
+/**
+ * @brief Default reservation policy of PQueue, every priority may take every slot
+ */
+struct PQueueNoReservation {
+    static constexpr PQueueBand BANDS[] = { {0, 0} };
+};
+
+/**
+ * @brief Admission table of a reservation policy, built at compile time. Band i holds the priorities from
+ *        BANDS[i].minPriority up to the next higher band, the priorities below every entry (if the last entry is
+ *        not at priority 0) form one more band. A band may fill the queue up to SIZE less the slots reserved by
+ *        the bands above it.
+ */
+template<typename RESERVATION, size_t SIZE>
+struct PQueueAdmission {
+    static constexpr uint8_t NUM_ENTRIES = sizeof(RESERVATION::BANDS) / sizeof(PQueueBand);
+    static constexpr uint8_t NUM_BANDS = (RESERVATION::BANDS[NUM_ENTRIES - 1].minPriority == 0) ? NUM_ENTRIES : NUM_ENTRIES + 1;
+
+    uint8_t band[256];           // Band of each priority
+    uint16_t limit[NUM_BANDS];   // Max number of queued items when admitting an item of each band
+
+    constexpr PQueueAdmission() : band(), limit() {
+        uint16_t reservedAbove = 0;
+        for(uint8_t i = 0; i < NUM_ENTRIES; i++) {
+            limit[i] = static_cast<uint16_t>(SIZE - reservedAbove);
+            reservedAbove += RESERVATION::BANDS[i].reserved;
+        }
+        if(NUM_BANDS > NUM_ENTRIES) {
+            limit[NUM_ENTRIES] = static_cast<uint16_t>(SIZE - reservedAbove);
+        }
+
+        for(uint16_t priority = 0; priority < 256; priority++) {
+            uint8_t i = 0;
+            while(i < NUM_ENTRIES && priority < RESERVATION::BANDS[i].minPriority) {
+                i++;
+            }
+            band[priority] = i;
+        }
+    }
+
+    static constexpr bool IsValid() {
+        size_t reserved = 0;
+        for(uint8_t i = 0; i < NUM_ENTRIES; i++) {
+            if(i > 0 && RESERVATION::BANDS[i].minPriority >= RESERVATION::BANDS[i - 1].minPriority) {
+                return false;
+            }
+            reserved += RESERVATION::BANDS[i].reserved;
+        }
+        return reserved < SIZE;
+    }
+};
+
+/**
+ * @brief Item argument of the PQueue and DeadlineQueue sends, a Command is taken by reference so a rejected
+ *        send can release its payload, as Queue::Send does
+ */
+template<typename T>
+using PQueueItemRef = std::conditional_t<std::is_same<T, Command>::value, T&, const T&>;
+template<typename T>
+using PQueueItemArray = std::conditional_t<std::is_same<T, Command>::value, T*, const T*>;
+
+/**
+ * @brief Releases the payload of a Command rejected or dropped by a PQueue or DeadlineQueue, other items own nothing
+ */
+template<typename T>
+inline void PQueueDrop(T& item) {
+    if constexpr (std::is_same<T, Command>::value) {
+        item.Reset();
+    }
+}
+
+/**
+ * @brief Type independent part of PQueue and DeadlineQueue, slot allocation and the RTOS counting semaphore
+ */
+class PQueueCore {
+public:
+    ~PQueueCore();
+
+    bool IsEmpty() const { return numFree_ == depth_; }
+    bool IsFull() const { return numFree_ == 0; }
+    uint16_t GetCurrentCount() const { return depth_ - numFree_; }
+    uint16_t GetMaxDepth() const { return depth_; }
+    SemaphoreHandle_t GetRTOSHandle() const { return rtSemaphoreHandle_; }    // Holds one count per queued item
+#ifdef QUEUE_INSTRUMENTATION
+    const QueueStats& GetStats() const { return stats; }
+    void PrintStats(const char* name) const { stats.Print(name); }
+    void ClearStats() { stats.Clear(); }
+#endif
+
+protected:
+    PQueueCore(uint16_t depth, uint16_t* freeSlots);
+
+    // Slot allocation, must be called inside the critical section
+    void InitSlots();    // Marks every slot free, called by the PQueue constructor once its storage exists
+    uint16_t AllocateSlot() { return freeSlots_[--numFree_]; }
+    void FreeSlot(uint16_t slot) { freeSlots_[numFree_++] = slot; }
+
+    // Signaling, outside of the critical section
+    bool WaitItem(TickType_t waitTicks) { return xSemaphoreTake(rtSemaphoreHandle_, waitTicks) == pdTRUE; }
+    void SignalItems(uint16_t count);
+    void SignalItemFromISR(BaseType_t* pxHigherPriorityTaskWoken);
+
+    SemaphoreHandle_t rtSemaphoreHandle_;
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    StaticSemaphore_t rtSemaphoreBuffer_;    // RTOS semaphore control block, the queue never uses the RTOS heap
+#endif
+    uint16_t* freeSlots_;    // Stack of free item slots
+    uint16_t numFree_;
+    uint16_t depth_;
+
+#ifdef QUEUE_INSTRUMENTATION
+    QueueStats stats = {};
+#endif
+
+private:
+    PQueueCore(const PQueueCore&);    // Prevent copy-construction
+};
+
 /**
  * @brief Priority Queue Class
- * 
+ *
  * @tparam T Object for the priority queue
  * @tparam SIZE Depth of the priority queue in number of objects
+ * @tparam ORDER Ordering policy, PQueueHeapOrder (default) or PQueueBucketOrder
+ * @tparam RESERVATION Capacity reservation table, PQueueNoReservation (default) or a struct with a PQueueBand BANDS[] table
  */
-template<typename T, const size_t SIZE>
-class PQueue {
+template<typename T, const size_t SIZE, template<size_t> class ORDER = PQueueHeapOrder,
+         typename RESERVATION = PQueueNoReservation>
+class PQueue : public PQueueCore {
 public:
     PQueue();
 
-    bool Send(const T& item, uint8_t priority = Priority::NORMAL); // Intentionally uint8_t to allow Priority::NORMAL+1 for example
+    // A rejected Command is reset (its payload released), use the UniqueCommand overloads to keep it
+    bool Send(PQueueItemRef<T> item, uint8_t priority = Priority::NORMAL); // Intentionally uint8_t to allow Priority::NORMAL+1 for example
+    bool SendFromISR(PQueueItemRef<T> item, uint8_t priority = Priority::NORMAL, BaseType_t* pxHigherPriorityTaskWoken = nullptr);    // nullptr yields internally
     bool Receive(T& item, uint32_t timeout_ms = 0);
     bool ReceiveWait(T& item);
 
-    bool IsEmpty() const { return rtQueue_.IsEmpty(); }
-    bool IsFull() const { return rtQueue_.IsFull(); }
-    uint16_t GetCurrentCount() const { return rtQueue_.GetQueueMessageCount(); }
-    uint16_t GetMaxDepth() const { return rtQueue_.GetQueueDepth(); }
+    uint16_t SendMany(PQueueItemArray<T> items, uint16_t count, uint8_t priority = Priority::NORMAL);
+    uint16_t ReceiveMany(T items[], uint16_t maxCount, uint32_t timeout_ms = 0);
+
+    // Owning interface for PQueue<Command>, ownership moves into the queue on success and stays with the caller on failure
+    template<typename U = T, typename = std::enable_if_t<std::is_same<U, Command>::value>>
+    bool Send(UniqueCommand&& item, uint8_t priority = Priority::NORMAL);
+    template<typename U = T, typename = std::enable_if_t<std::is_same<U, Command>::value>>
+    bool SendFromISR(UniqueCommand&& item, uint8_t priority = Priority::NORMAL, BaseType_t* pxHigherPriorityTaskWoken = nullptr);
+    template<typename U = T, typename = std::enable_if_t<std::is_same<U, Command>::value>>
+    bool Receive(UniqueCommand& item, uint32_t timeout_ms = 0);    // Releases any payload item already owns
+    template<typename U = T, typename = std::enable_if_t<std::is_same<U, Command>::value>>
+    bool ReceiveWait(UniqueCommand& item);
+
+    // Capacity reservation
+    static constexpr uint8_t GetNumBands() { return Admission::NUM_BANDS; }
+    static uint8_t GetBand(uint8_t priority) {    // Band of a priority, always 0 without reservation (no table is used)
+        if constexpr (std::is_same<RESERVATION, PQueueNoReservation>::value) {
+            (void)priority;
+            return 0;
+        }
+        else {
+            return ADMISSION.band[priority];
+        }
+    }
+    uint32_t GetRejectedCount(uint8_t band) const { return (band < Admission::NUM_BANDS) ? bandRejected_[band] : 0; }    // Sends rejected (full or reserved) per band
 
 private:
-    void HandleConsistencyError();
-    void NotifySelf() { uint8_t item = RTQUEUE_ITEM; rtQueue_.Send(item); }
+    typedef PQueueAdmission<RESERVATION, SIZE> Admission;
+    static constexpr Admission ADMISSION = {};    // Only odr-used with a reservation, PQueueNoReservation keeps no table
 
-private:
-    struct PriorityQueueItem {
-        T data_;
-        uint8_t priority_;
-        seq_t order_;
-#ifdef PQUEUE_ENABLE_SEQN_CIRCULAR_CHECK
-        const seq_t* pSeqN_;
-#endif
+    static_assert(SIZE > 0 && SIZE <= UINT16_MAX, "PQueue SIZE must fit the 16-bit slot index");
+    static_assert(Admission::IsValid(), "PQueue reservation bands must be ordered by descending minPriority and reserve less than SIZE");
 
-        bool operator<(const PriorityQueueItem& other) const {
-            if(priority_ == other.priority_) {
-#ifdef PQUEUE_ENABLE_SEQN_CIRCULAR_CHECK
-                CUBE_ASSERT(pSeqN_ != nullptr, "PQueue null seqn pointer");
-                seq_t seqN = *pSeqN_;
-                if((order_ < seqN && other.order_ < seqN) ||
-                   (order_ >= seqN && other.order_ >= seqN)) {
-                    // Both are before wrap-around or after wrap-around
-                    return order_ > other.order_;
-                }
-                else if(order_ < seqN) {
-                    // This is after wrap-around, other is before
-                    return true;
-                }
-                else {
-                    // This is before wrap-around, other is after
-                    return false;
-                }
-#else
-                return order_ > other.order_;
-#endif
+    bool AdmitLocked(uint8_t priority) {    // O(1) admission check, must be called inside the critical section
+        if constexpr (std::is_same<RESERVATION, PQueueNoReservation>::value) {
+            if(!IsFull()) {
+                return true;
             }
-            else {
-                return priority_ < other.priority_;
+            bandRejected_[0] += 1;
+            return false;
+        }
+        else {
+            const uint8_t band = ADMISSION.band[priority];
+            if(GetCurrentCount() < ADMISSION.limit[band]) {
+                return true;
             }
+            bandRejected_[band] += 1;
+            return false;
         }
-    };
+    }
 
-    TQueue<uint8_t> rtQueue_;
-    etl::priority_queue<PriorityQueueItem, SIZE> etlQueue_;
-    Mutex mtx_;
-    seq_t seqN_;
+    bool SendItem(const T& item, uint8_t priority);    // Send without releasing a rejected item
+    bool SendItemFromISR(const T& item, uint8_t priority, BaseType_t* pxHigherPriorityTaskWoken);
+    bool ReceiveTicks(T& item, TickType_t waitTicks);
+    void PushLocked(const T& item, uint8_t priority);
+    void PopLocked(T& item);
 
-    uint8_t errCount_;
+    T items_[SIZE];
+    uint16_t slotStack_[SIZE];
+    ORDER<SIZE> order_;
+    uint32_t bandRejected_[Admission::NUM_BANDS] = {};
 };
 
 /* Functions ---------------------------------------------------------------------*/
 /**
- * @brief Construct a new PQueue<T, SIZE>::PQueue object
- * 
+ * Pushes an entry to the heap, the heap must have room for it.
+ *
+ * @param entry The entry, its sequence number is set by the heap.
+ */
+template<typename ENTRY, typename BEFORE>
+void PQueueSlotHeap<ENTRY, BEFORE>::Push(Entry entry) {
+    entry.order_ = seqN_;
+    seqN_ += 1;
+
+    // Sift up from the new leaf
+    uint16_t index = size_++;
+    while(index > 0) {
+        const uint16_t parent = (index - 1) / 2;
+        if(!BEFORE()(entry, heap_[parent])) {
+            break;
+        }
+        heap_[index] = heap_[parent];
+        index = parent;
+    }
+    heap_[index] = entry;
+}
+
+/**
+ * Pops the first entry from the heap, the heap must not be empty.
+ *
+ * @return The entry.
+ */
+template<typename ENTRY, typename BEFORE>
+ENTRY PQueueSlotHeap<ENTRY, BEFORE>::Pop() {
+    const Entry first = heap_[0];
+    const Entry last = heap_[--size_];
+
+    // If the queue is now empty, we can reset the sequence number
+    if(size_ == 0) {
+        seqN_ = 0;
+        return first;
+    }
+
+    // Sift the last entry down from the root
+    uint16_t index = 0;
+    while(true) {
+        uint16_t child = 2 * index + 1;
+        if(child >= size_) {
+            break;
+        }
+        if(child + 1 < size_ && BEFORE()(heap_[child + 1], heap_[child])) {
+            child += 1;
+        }
+        if(!BEFORE()(heap_[child], last)) {
+            break;
+        }
+        heap_[index] = heap_[child];
+        index = child;
+    }
+    heap_[index] = last;
+
+    return first;
+}
+
+/**
+ * @brief Construct a new PQueue<T, SIZE, ORDER, RESERVATION>::PQueue object
+ *
  * @tparam T Object for the priority queue
  * @tparam SIZE Depth of the priority queue in N objects
  */
-template<typename T, const size_t SIZE>
-PQueue<T, SIZE>::PQueue() : 
-    rtQueue_(SIZE)
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+PQueue<T, SIZE, ORDER, RESERVATION>::PQueue() :
+    PQueueCore(SIZE, slotStack_)
  {
-    errCount_ = 0;
-    seqN_ = 0;
+    InitSlots();
  }
 
 /**
  * Sends an item with a specified priority to the priority queue.
  *
- * @param item The item to be sent to the priority queue.
+ * @param item The item to be sent to the priority queue, a rejected Command is reset.
  * @param priority The priority of the item.
  *
  * @return True if the item was successfully sent, false otherwise.
  */
-template<typename T, const size_t SIZE>
-bool PQueue<T, SIZE>::Send(const T& item, uint8_t priority) {
-    // If we cannot acquire the priority queue mutex, do nothing
-    if(!mtx_.Lock(PQUEUE_MTX_TIMEOUT_MS)) {
-        return false;
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+bool PQueue<T, SIZE, ORDER, RESERVATION>::Send(PQueueItemRef<T> item, uint8_t priority) {
+    if(SendItem(item, priority)) {
+        return true;
     }
 
-    // If the queue is full we cannot do anything
-    if (etlQueue_.full()) {
-        return false;
+    PQueueDrop(item);
+    return false;
+}
+
+/**
+ * Sends an item with a specified priority to the priority queue, safe to call from ISR.
+ *
+ * @param item The item to be sent to the priority queue, a rejected Command is reset.
+ * @param priority The priority of the item.
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the send woke a higher priority task, the caller must then call
+ *        portYIELD_FROM_ISR before the ISR exits. If nullptr (default), the context switch is requested internally.
+ *
+ * @return True if the item was successfully sent, false if the queue is full for this priority.
+ */
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+bool PQueue<T, SIZE, ORDER, RESERVATION>::SendFromISR(PQueueItemRef<T> item, uint8_t priority, BaseType_t* pxHigherPriorityTaskWoken) {
+    if(SendItemFromISR(item, priority, pxHigherPriorityTaskWoken)) {
+        return true;
     }
 
-    // Push an item to the priority queue
-#ifdef PQUEUE_ENABLE_SEQN_CIRCULAR_CHECK
-    etlQueue_.push({item, priority, seqN_, &seqN_});
-#else
-    etlQueue_.push({item, priority, seqN_});
-#endif
+    PQueueDrop(item);
+    return false;
+}
 
-    // Update the sequence number
-    seqN_ += 1;
+/**
+ * Sends an item with a specified priority to the priority queue, a rejected item is left as it is.
+ *
+ * @param item The item to be sent to the priority queue.
+ * @param priority The priority of the item.
+ *
+ * @return True if the item was successfully sent, false otherwise.
+ */
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+bool PQueue<T, SIZE, ORDER, RESERVATION>::SendItem(const T& item, uint8_t priority) {
+    QUEUE_STATS_BEGIN();
+
+    // Store the item, if the queue is full for this priority we cannot do anything
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    const bool success = AdmitLocked(priority);
+    if(success) {
+        PushLocked(item, priority);
+    }
+    const uint16_t count = GetCurrentCount();
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
 
-    // Push an item to the RTOS queue
-    NotifySelf();
+    // Signal the consumer once the item is in the ordering
+    if(success) {
+        SignalItems(1);
+    }
 
-    // Unlock the priority queue mutex
-    mtx_.Unlock();
+    QUEUE_STATS_SEND(success, count);
+    return success;
+}
 
-    return true;
+/**
+ * Sends an item with a specified priority to the priority queue from an ISR, a rejected item is left as it is.
+ *
+ * @param item The item to be sent to the priority queue.
+ * @param priority The priority of the item.
+ * @param pxHigherPriorityTaskWoken See SendFromISR, nullptr requests the context switch internally.
+ *
+ * @return True if the item was successfully sent, false if the queue is full for this priority.
+ */
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+bool PQueue<T, SIZE, ORDER, RESERVATION>::SendItemFromISR(const T& item, uint8_t priority, BaseType_t* pxHigherPriorityTaskWoken) {
+    // Store the item, if the queue is full for this priority we cannot do anything
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    const bool success = AdmitLocked(priority);
+    if(success) {
+        PushLocked(item, priority);
+    }
+    const uint16_t count = GetCurrentCount();
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    // Signal the consumer once the item is in the ordering
+    if(success) {
+        SignalItemFromISR(pxHigherPriorityTaskWoken);
+    }
+
+    QUEUE_STATS_SEND_NO_WAIT(success, count);
+    return success;
 }
 
 /**
@@ -202,98 +589,215 @@ bool PQueue<T, SIZE>::Send(const T& item, uint8_t priority) {
  *
  * @return true if an item was successfully received, false otherwise
  */
-template<typename T, const size_t SIZE>
-bool PQueue<T, SIZE>::Receive(T& item, uint32_t timeout_ms) {
-    // RTOS Queue Poll, if no item, return false
-    uint8_t rtqItem;
-    if(!rtQueue_.Receive(rtqItem, timeout_ms)) {
-        return false;
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+bool PQueue<T, SIZE, ORDER, RESERVATION>::Receive(T& item, uint32_t timeout_ms) {
+    return ReceiveTicks(item, MS_TO_TICKS(timeout_ms));
+}
+
+/**
+ * Wait forever for an item to be available in the priority queue.
+ *
+ * @param item the item to be received into from the priority queue
+ *
+ * @return true if the item was successfully received, false otherwise
+ */
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+bool PQueue<T, SIZE, ORDER, RESERVATION>::ReceiveWait(T& item) {
+    return ReceiveTicks(item, HAL_MAX_DELAY);
+}
+
+/**
+ * Sends several items with the same priority to the priority queue. The items that fit are admitted and pushed
+ * in one critical section (at most SIZE pushes with interrupts masked), then signaled with the scheduler
+ * suspended, so a waiting receiver is woken once for the batch.
+ *
+ * @param items The items to be sent to the priority queue, rejected Commands are reset.
+ * @param count The number of items.
+ * @param priority The priority of the items.
+ *
+ * @return The number of items sent, the first items of the array are always the ones sent.
+ */
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+uint16_t PQueue<T, SIZE, ORDER, RESERVATION>::SendMany(PQueueItemArray<T> items, uint16_t count, uint8_t priority) {
+    QUEUE_STATS_BEGIN();
+
+    // Push as many items as fit to the priority queue
+    uint16_t numSent = 0;
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    const uint16_t startCount = GetCurrentCount();
+    while(numSent < count && AdmitLocked(priority)) {
+        PushLocked(items[numSent], priority);
+        numSent++;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    for(uint16_t i = 0; i < numSent; i++) {
+        if(i == 0) {
+            QUEUE_STATS_SEND(true, startCount + 1);
+        }
+        else {
+            QUEUE_STATS_SEND_NO_WAIT(true, startCount + i + 1);
+        }
+    }
+    if(numSent < count) {
+        QUEUE_STATS_SEND_NO_WAIT(false, startCount + numSent);
     }
 
-    // If we failed to acquire the priority queue mutex, you must add another item to the rtos queue to ensure size consistency
-	if(!mtx_.Lock(PQUEUE_MTX_TIMEOUT_MS)) {
-		NotifySelf();
-		return false;
-	}
+    // Signal every pushed item
+    SignalItems(numSent);
 
-    // If there is an empty etlQueue after getting a rtQueue_ response, we have a queue consistency error
-    if (etlQueue_.empty()) {
-        HandleConsistencyError();
-        return false;
+    // Release the items that did not fit
+    for(uint16_t i = numSent; i < count; i++) {
+        PQueueDrop(items[i]);
     }
-    
-    // Get the item from the etlQueue and pop it
-    item = etlQueue_.top().data_;
-    etlQueue_.pop();
 
-    // If the queue is now empty, we can reset the sequence number
-    if(IsEmpty()) { 
-        seqN_ = 0;
+    return numSent;
+}
+
+/**
+ * Receives up to maxCount items from the priority queue in priority order, blocks for the first item
+ * then takes every item that is already queued.
+ *
+ * @param items the array to receive the items into
+ * @param maxCount the size of the array
+ * @param timeout_ms the timeout in milliseconds to wait for the first item
+ *
+ * @return the number of items received
+ */
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+uint16_t PQueue<T, SIZE, ORDER, RESERVATION>::ReceiveMany(T items[], uint16_t maxCount, uint32_t timeout_ms) {
+    if(maxCount == 0 || !ReceiveTicks(items[0], MS_TO_TICKS(timeout_ms))) {
+        return 0;
     }
 
-    // Unlock the priority queue mutex
-    mtx_.Unlock();
+    uint16_t numReceived = 1;
+    while(numReceived < maxCount && WaitItem(0)) {
+        UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+        PopLocked(items[numReceived++]);
+        taskEXIT_CRITICAL_FROM_ISR(savedMask);
+        QUEUE_STATS_RECEIVE_NO_WAIT(true);
+    }
+
+    return numReceived;
+}
+
+/**
+ * Sends an owned command with a specified priority to the priority queue. On failure the command stays owned
+ * by the caller.
+ *
+ * @param item The owned command to be sent to the priority queue.
+ * @param priority The priority of the command.
+ *
+ * @return True if the command was successfully sent, false otherwise.
+ */
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+template<typename U, typename>
+bool PQueue<T, SIZE, ORDER, RESERVATION>::Send(UniqueCommand&& item, uint8_t priority) {
+    if(!SendItem(item.cmd, priority)) {
+        return false;
+    }
 
+    item.Disown();
     return true;
 }
 
 /**
- * Wait forever for an item to be available in the priority queue.
+ * Sends an owned command with a specified priority to the priority queue, safe to call from ISR. On failure the
+ * command stays owned by the caller.
  *
- * @param item the item to be received into from the priority queue
+ * @param item The owned command to be sent to the priority queue.
+ * @param priority The priority of the command.
+ * @param pxHigherPriorityTaskWoken See SendFromISR, nullptr (default) requests the context switch internally.
  *
- * @return true if the item was successfully received, false otherwise
+ * @return True if the command was successfully sent, false if the queue is full for this priority.
  */
-template<typename T, const size_t SIZE>
-bool PQueue<T, SIZE>::ReceiveWait(T& item) {
-    return Receive(item, TICKS_TO_MS(HAL_MAX_DELAY));
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+template<typename U, typename>
+bool PQueue<T, SIZE, ORDER, RESERVATION>::SendFromISR(UniqueCommand&& item, uint8_t priority, BaseType_t* pxHigherPriorityTaskWoken) {
+    if(!SendItemFromISR(item.cmd, priority, pxHigherPriorityTaskWoken)) {
+        return false;
+    }
+
+    item.Disown();
+    return true;
 }
 
 /**
- * Handles a consistency error in the PQueue class.
+ * Receives the highest priority command into an owner, any payload the owner held is released first.
+ *
+ * @param item the owner to receive the command into
+ * @param timeout_ms the timeout in milliseconds to wait for a command to be available in the queue
  *
- * Prints an error message through debug. Then, it counts the number of errors 
- * and checks if it exceeds the maximum limit. If the error count exceeds the limit, the function 
- * fails an assert.
- * 
- * In the event of a consistency error, this function will pop and add items to the RT queue until
- * it matches that of the priority queue.
+ * @return true if a command was successfully received, false otherwise (item is left empty)
+ */
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+template<typename U, typename>
+bool PQueue<T, SIZE, ORDER, RESERVATION>::Receive(UniqueCommand& item, uint32_t timeout_ms) {
+    item.Reset();
+    return Receive(item.cmd, timeout_ms);
+}
+
+/**
+ * Wait forever for a command to be available in the priority queue and receive it into an owner, any payload
+ * the owner held is released first.
  *
- * @tparam T The type of elements in the priority queue.
- * @tparam SIZE The maximum size of the priority queue.
+ * @param item the owner to receive the command into
  *
- * @return true if the consistency error was handled successfully, false otherwise.
+ * @return true if the command was successfully received, false otherwise
  */
-template<typename T, const size_t SIZE>
-void PQueue<T, SIZE>::HandleConsistencyError() {
-    // Print an error
-    CUBE_PRINT("ERROR: PQueue Data Consistency\r\n");
-
-    // Count the error, if it exceeds the max, we must reset the system
-    CUBE_ASSERT(++errCount_ > PQUEUE_ERROR_COUNT_MAX,
-			"PQueue data consistency faults exceeded limits");
-
-    // Pop/Add items to the RT queue until it matches that of the priority queue
-    uint16_t pQueueSize = etlQueue_.size();
-    uint16_t rtQueueSize = rtQueue_.GetQueueMessageCount();
-    if(pQueueSize == rtQueueSize) {
-        // Size consistent, do nothing
-        --errCount_;
-        return;
-    }
-    else if(pQueueSize > rtQueueSize) {
-        // Add items until we reach the size of the priority queue
-        for(uint16_t i = rtQueueSize; i < pQueueSize; i++) {
-            NotifySelf();
-        }
-    }
-    else {
-        // Remove items until we reach the size of the priority queue
-        for(uint16_t i = pQueueSize; i < rtQueueSize; i++) {
-            uint8_t item;
-            rtQueue_.Receive(item);
-        }
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+template<typename U, typename>
+bool PQueue<T, SIZE, ORDER, RESERVATION>::ReceiveWait(UniqueCommand& item) {
+    item.Reset();
+    return ReceiveWait(item.cmd);
+}
+
+/**
+ * Waits for an item to be signaled and takes the highest priority item.
+ *
+ * @param item the item to be received into from the priority queue
+ * @param waitTicks the ticks to wait for an item to be available in the queue
+ *
+ * @return true if an item was successfully received, false otherwise
+ */
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+bool PQueue<T, SIZE, ORDER, RESERVATION>::ReceiveTicks(T& item, TickType_t waitTicks) {
+    QUEUE_STATS_BEGIN();
+
+    // Every semaphore count matches an item in the ordering
+    if(!WaitItem(waitTicks)) {
+        QUEUE_STATS_RECEIVE(false);
+        return false;
     }
+
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    PopLocked(item);
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    QUEUE_STATS_RECEIVE(true);
+    return true;
+}
+
+/**
+ * Stores an item in a free slot and pushes the slot to the ordering, must be called inside the critical section
+ * with a free slot available.
+ */
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+void PQueue<T, SIZE, ORDER, RESERVATION>::PushLocked(const T& item, uint8_t priority) {
+    const uint16_t slot = AllocateSlot();
+    items_[slot] = item;
+    order_.Push(slot, priority);
+}
+
+/**
+ * Pops the highest priority slot from the ordering and frees it, must be called inside the critical section
+ * with an item in the ordering.
+ */
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION>
+void PQueue<T, SIZE, ORDER, RESERVATION>::PopLocked(T& item) {
+    const uint16_t slot = order_.Pop();
+    item = items_[slot];
+    FreeSlot(slot);
 }
 
 #endif // CUBE_PLUSPLUS_INCLUDE_PRIORITY_QUEUE_H
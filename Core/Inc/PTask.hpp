@@ -10,6 +10,8 @@
 /* Includes ------------------------------------------------------------------*/
 #include <cmsis_os.h>
 #include "PQueue.hpp"
+#include "EventQueueTask.hpp"
+#include "Command.hpp"
 #include "SystemDefines.hpp"
 
 /* Macros and Constants --------------------------------------------------*/
@@ -18,26 +20,12 @@ constexpr uint16_t DEFAULT_PQUEUE_DEPTH = 10;
 /* Enums -----------------------------------------------------------------*/
 
 /* Class -----------------------------------------------------------------*/
-class PTask<const size_t DEPTH = DEFAULT_PQUEUE_DEPTH> {
+template<const size_t DEPTH = DEFAULT_PQUEUE_DEPTH, template<size_t> class ORDER = PQueueHeapOrder,
+         typename RESERVATION = PQueueNoReservation>
+class PTask : public EventQueueTask<PQueue<Command, DEPTH, ORDER, RESERVATION>, uint8_t, Priority::NORMAL> {
 public:
     //Constructors
-    PTask(void) {
-        rtTaskHandle_ = nullptr;
-        qEvtQueue_ = new PQueue<Command,DEPTH>();
-    }
-
-    virtual void InitTask() = 0; 
-
-    PQueue<Command, DEPTH>* GetEventQueue() const { return qEvtQueue_; }
-    void SendCommand(Command cmd, uint8_t priority) { qEvtQueue->Send(cmd, priority); }
-    void SendCommandReference(Command& cmd, uint8_t priority) { qEvtQueue->Send(cmd, priority); }
-
-protected:
-    //RTOS
-    TaskHandle_t rtTaskHandle_;   // RTOS Task Handle
-
-    //Task structures
-    PQueue<Command,DEPTH>* qEvtQueue_;    // Task event queue
+    PTask(void) {}
 };
 
 #endif /* CUBE_INCLUDE_CORE_PRIORITY_TASK_HPP */
@@ -0,0 +1,183 @@
+/**
+ ******************************************************************************
+ * File Name          : PoolQueue.hpp
+ * Description        :
+ *
+ *    PoolQueue<T> passes large objects between tasks by pointer. Producers
+ *    acquire an object from an ObjectPool<T, SIZE>, fill it in place and send
+ *    the PoolPtr owner, consumers receive a PoolPtr that returns the object to
+ *    the pool when it is reset or destroyed.
+ *
+ *    The RTOS queue only holds the pointer, so each queue item is
+ *    sizeof(T*) and a send / receive copies 4 bytes instead of sizeof(T)
+ *    twice as TQueue<T> does. The objects live in the pool, which bounds the
+ *    number of objects in flight across every queue sharing it.
+ *
+ *    Ownership moves into the queue on a successful send and stays with the
+ *    caller on failure, same as the UniqueCommand overloads of Queue.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_INCLUDE_CORE_POOL_QUEUE_H
+#define CUBE_PLUSPLUS_INCLUDE_CORE_POOL_QUEUE_H
+/* Includes ------------------------------------------------------------------*/
+#include "cmsis_os.h"
+#include "SystemDefines.hpp"
+#include "ObjectPool.hpp"
+#include "TQueue.hpp"
+
+/* Class -----------------------------------------------------------------*/
+
+/**
+ * @brief PoolQueue class, queue of PoolPtr owners of objects from one ObjectPool
+*/
+template<typename T>
+class PoolQueue {
+public:
+    //Constructors / Destructor
+    PoolQueue(ObjectPoolBase<T>& pool, uint16_t depth = DEFAULT_QUEUE_SIZE);
+    ~PoolQueue();
+
+    //Functions
+    bool Send(PoolPtr<T>&& object);
+    bool SendFromISR(PoolPtr<T>&& object, BaseType_t* pxHigherPriorityTaskWoken = nullptr);    // nullptr yields internally
+    bool SendToFront(PoolPtr<T>&& object);
+
+    bool Receive(PoolPtr<T>& object, uint32_t timeout_ms = 0);    // Releases any object already owned by the target
+    bool ReceiveWait(PoolPtr<T>& object); //Blocks until an object is received
+
+    //Getters
+    uint16_t GetQueueMessageCount() const { return queue.GetQueueMessageCount(); }
+    uint16_t GetQueueDepth() const { return queue.GetQueueDepth(); }
+    QueueHandle_t GetRTOSHandle() const { return queue.GetRTOSHandle(); }
+    ObjectPoolBase<T>& GetPool() const { return pool; }
+
+    bool IsEmpty() const { return queue.IsEmpty(); }
+    bool IsFull() const { return queue.IsFull(); }
+
+protected:
+    bool IsSendable(const PoolPtr<T>& object) const { return object && object.GetPool() == &pool; }
+
+    TQueue<T*> queue;           // Queue of objects owned by the queue
+    ObjectPoolBase<T>& pool;    // Pool every queued object belongs to
+
+private:
+    PoolQueue(const PoolQueue&);    // Prevent copy-construction
+};
+
+/**
+ * @brief Constructor for the PoolQueue class
+ * @param pool Pool the queued objects are acquired from and returned to
+ * @param depth Max number of objects in the queue
+*/
+template<typename T>
+PoolQueue<T>::PoolQueue(ObjectPoolBase<T>& pool, uint16_t depth) : queue(depth), pool(pool)
+{
+}
+
+/**
+ * @brief Destructor for the PoolQueue class, returns every queued object to the pool
+*/
+template<typename T>
+PoolQueue<T>::~PoolQueue()
+{
+    PoolPtr<T> dropped;
+    while (Receive(dropped)) {}
+}
+
+/**
+ * @brief Sends an object to the back of the queue
+ * @param object Owner of the object, emptied on success, keeps the object on failure
+ * @return true on success, false if the queue is full, the owner is empty or the object is from another pool
+*/
+template<typename T>
+bool PoolQueue<T>::Send(PoolPtr<T>&& object)
+{
+    if (!IsSendable(object))
+        return false;
+
+    T* item = object.Get();
+    if (!queue.Send(item))
+        return false;
+
+    object.Disown();
+    return true;
+}
+
+/**
+ * @brief Sends an object to the back of the queue, safe to call from ISR
+ * @param object Owner of the object, emptied on success, keeps the object on failure
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the send woke a higher priority task, nullptr (default) to
+ *        request the context switch internally
+ * @return true on success, false if the queue is full, the owner is empty or the object is from another pool
+*/
+template<typename T>
+bool PoolQueue<T>::SendFromISR(PoolPtr<T>&& object, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    if (!IsSendable(object))
+        return false;
+
+    T* item = object.Get();
+    if (!queue.SendFromISR(item, pxHigherPriorityTaskWoken))
+        return false;
+
+    object.Disown();
+    return true;
+}
+
+/**
+ * @brief Sends an object to the front of the queue
+ * @param object Owner of the object, emptied on success, keeps the object on failure
+ * @return true on success, false if the queue is full, the owner is empty or the object is from another pool
+*/
+template<typename T>
+bool PoolQueue<T>::SendToFront(PoolPtr<T>&& object)
+{
+    if (!IsSendable(object))
+        return false;
+
+    T* item = object.Get();
+    if (!queue.SendToFront(item))
+        return false;
+
+    object.Disown();
+    return true;
+}
+
+/**
+ * @brief Receives an object from the queue, blocks for timeout_ms if the queue is empty
+ * @param object Owner to move the object into, any object it already owns is returned to its pool first
+ * @param timeout_ms Time to block for
+ * @return TRUE if we received an object, FALSE otherwise
+*/
+template<typename T>
+bool PoolQueue<T>::Receive(PoolPtr<T>& object, uint32_t timeout_ms)
+{
+    object.Reset();
+
+    T* item = nullptr;
+    if (!queue.Receive(item, timeout_ms))
+        return false;
+
+    object = PoolPtr<T>(item, &pool);
+    return true;
+}
+
+/**
+ * @brief Blocks forever until an object is received
+ * @param object Owner to move the object into, any object it already owns is returned to its pool first
+ * @return TRUE if we received an object, FALSE otherwise (should rarely return false)
+*/
+template<typename T>
+bool PoolQueue<T>::ReceiveWait(PoolPtr<T>& object)
+{
+    object.Reset();
+
+    T* item = nullptr;
+    if (!queue.ReceiveWait(item))
+        return false;
+
+    object = PoolPtr<T>(item, &pool);
+    return true;
+}
+
+#endif /* CUBE_PLUSPLUS_INCLUDE_CORE_POOL_QUEUE_H */
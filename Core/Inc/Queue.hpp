@@ -8,6 +8,27 @@
  *
  *    Currently only handles Command objects, may want to make this a base template
  *    class for which CommandQueue inherits from.
+ *
+ *    In QUEUE_ITEM_HANDLE mode the RTOS queue only stores 32-bit handles, the
+ *    Commands are parked in the CommandSlotTable while they are queued. This
+ *    shrinks the queue storage from depth * sizeof(Command) to depth * 4 bytes
+ *    at the cost of a slot table store / take per send / receive.
+ *
+ *    The backpressure policy, chosen at construction, decides what Send does
+ *    when the queue is full (see QueueBackpressurePolicy). The replacing
+ *    policies (DROP_OLDEST, OVERWRITE_NEWEST, COALESCE) modify the queue
+ *    contents in an interrupt mask critical section with the FromISR queue
+ *    API (the non-blocking forms, which are valid with interrupts masked in
+ *    task context too). DROP_OLDEST is O(1), OVERWRITE_NEWEST and COALESCE
+ *    rotate every queued item once, so they are O(depth) on a full queue and
+ *    their depth is capped at QUEUE_REPLACING_MAX_DEPTH to bound the time
+ *    interrupts stay masked. Queues using a replacing policy must
+ *    not be members of a queue set (Task::AddEventSource), as replaced items
+ *    would be signalled to the set twice.
+ *
+ *    StaticQueue<DEPTH, ITEM_MODE> creates the RTOS queue in storage sized at
+ *    compile time (xQueueCreateStatic), so the queue RAM is placed by the
+ *    linker instead of taken from the FreeRTOS heap.
  ******************************************************************************
 */
 #ifndef CUBE_PLUSPLUS_INCLUDE_SOAR_CORE_QUEUE_H
@@ -15,42 +36,152 @@
 /* Includes ------------------------------------------------------------------*/
 #include <cmsis_os.h>
 #include "Command.hpp"
+#include "CommandSlotTable.hpp"
+#include "UniqueCommand.hpp"
+#include "QueueStats.hpp"
 #include "CubeUtils.hpp"
 #include "FreeRTOS.h"
 
+/* User Configurable Defines -------------------------------------------------*/
+#ifndef QUEUE_REPLACING_MAX_DEPTH // Max depth of OVERWRITE_NEWEST / COALESCE queues, bounds the items rotated with interrupts masked
+#define QUEUE_REPLACING_MAX_DEPTH 16
+#endif
+
 /* Macros --------------------------------------------------------------------*/
-#define DEFAULT_QUEUE_SEND_WAIT_TICKS (MS_TO_TICKS(15))    // We wait a max of 15ms to send to a queue
+#define DEFAULT_QUEUE_SEND_WAIT_MS 15    // We wait a max of 15ms to send to a queue
+#define DEFAULT_QUEUE_SEND_WAIT_TICKS (MS_TO_TICKS(DEFAULT_QUEUE_SEND_WAIT_MS))
 
 /* Constants -----------------------------------------------------------------*/
 //constexpr uint16_t MAX_TICKS_TO_WAIT_SEND = MS_TO_TICKS(1000);
 
+/* Enums -----------------------------------------------------------------*/
+enum QueueItemMode : uint8_t {
+    QUEUE_ITEM_COMMAND = 0,    // Queue items are full Command objects
+    QUEUE_ITEM_HANDLE,         // Queue items are CommandSlotTable handles
+};
+
+enum QueueBackpressurePolicy : uint8_t {
+    QUEUE_POLICY_BLOCK = 0,           // Wait up to the send timeout for space, then drop the new command (default)
+    QUEUE_POLICY_FAIL_FAST,           // Drop the new command immediately
+    QUEUE_POLICY_DROP_OLDEST,         // Release the oldest queued command to make room
+    QUEUE_POLICY_OVERWRITE_NEWEST,    // Release the newest queued command and put the new command in its place, depth <= QUEUE_REPLACING_MAX_DEPTH
+    QUEUE_POLICY_COALESCE,            // Replace the queued command with the same GLOBAL_COMMANDS / taskCommand, drop the new command if there is none, depth <= QUEUE_REPLACING_MAX_DEPTH
+};
+
+/* Structs -----------------------------------------------------------------*/
+struct QueueDropCounters {
+    uint32_t droppedNew;       // New commands dropped (timeout, fail fast, no coalesce match)
+    uint32_t droppedOldest;    // Queued commands released by DROP_OLDEST
+    uint32_t overwritten;      // Queued commands released by OVERWRITE_NEWEST
+    uint32_t coalesced;        // Queued commands replaced by COALESCE
+};
+
+/* Functions -----------------------------------------------------------------*/
+// Size of one RTOS queue item in the given item mode
+constexpr UBaseType_t GetQueueItemSize(QueueItemMode itemMode) {
+    return (itemMode == QUEUE_ITEM_HANDLE) ? sizeof(CommandHandle_t) : sizeof(Command);
+}
+
 /* Class -----------------------------------------------------------------*/
 
 class Queue {
 public:
     //Constructors
     Queue(void);
-    Queue(uint16_t depth);
+    Queue(uint16_t depth, QueueItemMode itemMode = QUEUE_ITEM_COMMAND);
+    Queue(uint16_t depth, QueueBackpressurePolicy policy, uint32_t sendTimeout_ms = DEFAULT_QUEUE_SEND_WAIT_MS,
+          QueueItemMode itemMode = QUEUE_ITEM_COMMAND);
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    // Creates the RTOS queue in the given storage, see StaticQueue
+    Queue(uint16_t depth, uint8_t* rtQueueStorage, StaticQueue_t* rtQueueBuffer, QueueItemMode itemMode = QUEUE_ITEM_COMMAND,
+          QueueBackpressurePolicy policy = QUEUE_POLICY_BLOCK, uint32_t sendTimeout_ms = DEFAULT_QUEUE_SEND_WAIT_MS);
+#endif
 
     //Functions
     bool Send(Command& command, bool reportFull = true);
-    bool SendFromISR(Command& command);
+    bool SendFromISR(Command& command, BaseType_t* pxHigherPriorityTaskWoken = nullptr);    // nullptr yields internally, or pass a flag for one portYIELD_FROM_ISR at the end of the ISR
 
     bool SendToFront(Command& command);
 
     bool Receive(Command& cm, uint32_t timeout_ms = 0);
     bool ReceiveWait(Command& cm); //Blocks until a command is received
 
+    // Batch interface, moves several commands per call / wakeup
+    uint16_t SendMany(Command commands[], uint16_t count, bool reportFull = true);
+    uint16_t ReceiveMany(Command cms[], uint16_t maxCount, uint32_t timeout_ms = 0);
+    uint16_t ReceiveManyWait(Command cms[], uint16_t maxCount); //Blocks until at least one command is received
+
+    // Owning interface, ownership moves into the queue on success and stays with the caller on failure
+    bool Send(UniqueCommand&& command, bool reportFull = true);
+    bool SendFromISR(UniqueCommand&& command, BaseType_t* pxHigherPriorityTaskWoken = nullptr);
+    bool SendToFront(UniqueCommand&& command);
+
+    bool Receive(UniqueCommand& cm, uint32_t timeout_ms = 0);    // Releases any payload cm already owns
+    bool ReceiveWait(UniqueCommand& cm);
+
     //Getters
     uint16_t GetQueueMessageCount() const { return uxQueueMessagesWaiting(rtQueueHandle); }
     uint16_t GetQueueDepth() const { return queueDepth; }
+    QueueHandle_t GetRTOSHandle() const { return rtQueueHandle; }
+#ifdef QUEUE_INSTRUMENTATION
+    const QueueStats& GetStats() const { return stats; }
+    void PrintStats(const char* name) const { stats.Print(name); }
+    void ClearStats() { stats.Clear(); }
+#endif
+    QueueItemMode GetItemMode() const { return itemMode; }
+    QueueBackpressurePolicy GetBackpressurePolicy() const { return policy; }
+    const QueueDropCounters& GetDropCounters() const { return dropCounters; }
 
 protected:
+    bool SendItem(Command& command, TickType_t waitTicks, bool toFront);
+    bool SendItemFromISR(Command& command, BaseType_t* higherPriorityTaskWoken);
+    bool ReceiveItem(Command& cm, TickType_t waitTicks);
+
+    bool SendWithPolicy(Command& command, BaseType_t* isrTaskWoken);
+    bool SendToFrontWithPolicy(Command& command);
+    bool SendReplacing(Command& command, BaseType_t* isrTaskWoken);
+    bool IsCoalesceMatch(const void* queuedItem, const Command& command) const;
+    void CountDrop(uint32_t& counter, uint32_t count = 1);
+    void CheckPolicyDepth() const;
+
     //RTOS
     QueueHandle_t rtQueueHandle;    // RTOS Event Queue Handle
     
     //Data
     uint16_t queueDepth;            // Max queue depth
+    QueueItemMode itemMode;         // What the RTOS queue stores for each Command
+    QueueBackpressurePolicy policy; // What Send does when the queue is full
+    TickType_t sendWaitTicks;       // Send timeout of QUEUE_POLICY_BLOCK
+    QueueDropCounters dropCounters = {};
+#ifdef QUEUE_INSTRUMENTATION
+    QueueStats stats = {};          // Queue statistics
+#endif
+};
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+/**
+ * @brief Storage of a StaticQueue, a separate base class so it is constructed before the Queue that uses it
+*/
+template<uint16_t DEPTH, QueueItemMode ITEM_MODE>
+class StaticQueueStorage {
+protected:
+    StaticQueue_t rtQueueBuffer;                                   // RTOS queue control block
+    uint8_t rtQueueStorage[DEPTH * GetQueueItemSize(ITEM_MODE)];   // RTOS queue item storage
+};
+
+/**
+ * @brief Queue with statically allocated RTOS storage, sized by the template parameters
+*/
+template<uint16_t DEPTH = DEFAULT_QUEUE_SIZE, QueueItemMode ITEM_MODE = QUEUE_ITEM_COMMAND>
+class StaticQueue : private StaticQueueStorage<DEPTH, ITEM_MODE>, public Queue {
+public:
+    StaticQueue(QueueBackpressurePolicy policy = QUEUE_POLICY_BLOCK, uint32_t sendTimeout_ms = DEFAULT_QUEUE_SEND_WAIT_MS) :
+        Queue(DEPTH, this->rtQueueStorage, &this->rtQueueBuffer, ITEM_MODE, policy, sendTimeout_ms) {}
+
+private:
+    StaticQueue(const StaticQueue&);               // Prevent copy-construction, the RTOS queue refers to this object
+    StaticQueue& operator=(const StaticQueue&);    // Prevent assignment
 };
+#endif
 
 #endif /* CUBE_PLUSPLUS_INCLUDE_SOAR_CORE_QUEUE_H */
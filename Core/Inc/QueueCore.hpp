@@ -0,0 +1,71 @@
+/**
+ ******************************************************************************
+ * File Name          : QueueCore.hpp
+ * Description        :
+ *
+ *    QueueCore is the type-erased part of TQueue, a FreeRTOS queue of items
+ *    of a fixed size given at construction. It implements every queue
+ *    operation once on untyped item pointers, TQueue<T> only adds inline
+ *    typed wrappers, so each new item type costs almost no flash.
+ *
+ *    The item functions are protected, items must be sent and received
+ *    through a typed wrapper. The getters are shared by every TQueue.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_INCLUDE_CUBE_CORE_QUEUE_CORE_H
+#define CUBE_PLUSPLUS_INCLUDE_CUBE_CORE_QUEUE_CORE_H
+/* Includes ------------------------------------------------------------------*/
+#include "cmsis_os.h"
+#include "QueueStats.hpp"
+#include "FreeRTOS.h"
+
+/* Class -----------------------------------------------------------------*/
+
+/**
+ * @brief QueueCore class, RTOS queue of fixed size items shared by every TQueue instantiation
+*/
+class QueueCore {
+public:
+    //Getters
+    uint16_t GetQueueMessageCount() const { return uxQueueMessagesWaiting(rtQueueHandle); }
+    uint16_t GetQueueDepth() const { return queueDepth; }
+    QueueHandle_t GetRTOSHandle() const { return rtQueueHandle; }
+#ifdef QUEUE_INSTRUMENTATION
+    const QueueStats& GetStats() const { return stats; }
+    void PrintStats(const char* name) const { stats.Print(name); }
+    void ClearStats() { stats.Clear(); }
+#endif
+
+    bool IsEmpty() const { return GetQueueMessageCount() == 0; }
+    bool IsFull() const { return GetQueueMessageCount() == queueDepth; }
+
+protected:
+    //Constructors
+    QueueCore(uint16_t depth, uint16_t itemSize);
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    QueueCore(uint16_t depth, uint16_t itemSize, uint8_t* rtQueueStorage, StaticQueue_t* rtQueueBuffer);
+#endif
+
+    //Functions, items are itemSize bytes, arrays are packed items
+    bool SendTicks(const void* item, TickType_t waitTicks, bool toFront);
+    bool SendItemFromISR(const void* item, BaseType_t* pxHigherPriorityTaskWoken);
+    bool ReceiveTicks(void* item, TickType_t waitTicks);
+
+    uint16_t SendItems(const void* items, uint16_t count);
+    uint16_t ReceiveItems(void* items, uint16_t maxCount, TickType_t waitTicks);
+
+    //RTOS
+    QueueHandle_t rtQueueHandle;    // RTOS Event Queue Handle
+
+    //Data
+    uint16_t queueDepth;            // Max queue depth
+    uint16_t itemSize;              // Size of one item in bytes
+#ifdef QUEUE_INSTRUMENTATION
+    QueueStats stats = {};          // Queue statistics
+#endif
+
+private:
+    QueueCore(const QueueCore&);    // Prevent copy-construction
+};
+
+#endif /* CUBE_PLUSPLUS_INCLUDE_CUBE_CORE_QUEUE_CORE_H */
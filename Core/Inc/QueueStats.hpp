@@ -0,0 +1,74 @@
+/**
+ ******************************************************************************
+ * File Name          : QueueStats.hpp
+ *
+ * Configuration      : Define macros in SystemDefines.hpp
+ *    #define QUEUE_INSTRUMENTATION - Enable per queue statistics on Queue,
+ *      TQueue and PQueue
+ *
+ * Description        :
+ *    QueueStats holds the statistics of one queue: peak depth, send and
+ *    receive counts, send failures (full / timeout), receive timeouts, the
+ *    cumulative and max time senders spent blocked and the cumulative time
+ *    the consumer spent waiting for an item. Times are in RTOS ticks.
+ *
+ *    Every queue keeps its own QueueStats, readable with GetStats() and
+ *    printable over the debug UART with PrintStats(name), so queue depths can
+ *    be sized from measured peaks.
+ *
+ *    When QUEUE_INSTRUMENTATION is not defined the QUEUE_STATS_* hooks compile
+ *    to nothing and the queues carry no statistics.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_INCLUDE_CORE_QUEUE_STATS_H
+#define CUBE_PLUSPLUS_INCLUDE_CORE_QUEUE_STATS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "cmsis_os.h"
+#include "SystemDefines.hpp"
+
+/* Macros --------------------------------------------------------------------*/
+// Hooks used by the queue classes, they expect a QueueStats member named stats. The NO_WAIT variants are
+// for ISR calls and for the items after the first of a batch, which never block
+#ifdef QUEUE_INSTRUMENTATION
+#define QUEUE_STATS_BEGIN() const TickType_t statsStartTick = xTaskGetTickCount()
+#define QUEUE_STATS_SEND(success, count) stats.RecordSend((success), xTaskGetTickCount() - statsStartTick, (count))
+#define QUEUE_STATS_SEND_NO_WAIT(success, count) stats.RecordSend((success), 0, (count))
+#define QUEUE_STATS_RECEIVE(success) stats.RecordReceive((success), xTaskGetTickCount() - statsStartTick)
+#define QUEUE_STATS_RECEIVE_NO_WAIT(success) stats.RecordReceive((success), 0)
+#else
+// The arguments are named in an unevaluated sizeof, so a variable kept only for the stats is not reported as
+// unused and no call in the arguments runs
+#define QUEUE_STATS_BEGIN() ((void)0)
+#define QUEUE_STATS_SEND(success, count) ((void)sizeof((success), (count)))
+#define QUEUE_STATS_SEND_NO_WAIT(success, count) ((void)sizeof((success), (count)))
+#define QUEUE_STATS_RECEIVE(success) ((void)sizeof(success))
+#define QUEUE_STATS_RECEIVE_NO_WAIT(success) ((void)sizeof(success))
+#endif
+
+#ifdef QUEUE_INSTRUMENTATION
+
+/* Structs -------------------------------------------------------------------*/
+/**
+ * @brief Statistics of one queue, updates are done in an interrupt mask critical section so they are ISR safe
+*/
+struct QueueStats {
+    uint16_t peakDepth;            // Highest number of items seen in the queue
+    uint32_t sendCount;            // Successful sends
+    uint32_t receiveCount;         // Successful receives
+    uint32_t sendFailures;         // Sends that failed (queue full after any wait)
+    uint32_t receiveTimeouts;      // Receives that returned without an item
+    uint32_t sendBlockTicks;       // Cumulative time senders spent blocked
+    uint32_t maxSendBlockTicks;    // Longest time a sender spent blocked
+    uint32_t receiveIdleTicks;     // Cumulative time the consumer spent waiting for an item
+
+    void RecordSend(bool success, TickType_t blockedTicks, uint16_t count);
+    void RecordReceive(bool success, TickType_t waitedTicks);
+
+    void Print(const char* name) const;
+    void Clear();
+};
+
+#endif /* QUEUE_INSTRUMENTATION */
+
+#endif /* CUBE_PLUSPLUS_INCLUDE_CORE_QUEUE_STATS_H */
@@ -0,0 +1,222 @@
+/**
+ ******************************************************************************
+ * File Name          : SPSCQueue.hpp
+ * Description        :
+ *
+ *    SPSCQueue is a lock-free single-producer single-consumer ring queue with
+ *    the same interface as TQueue, intended for ISR producers (UART bytes,
+ *    ADC samples, ...) feeding a single task.
+ *
+ *    The ring is a fixed array with atomic read and write indices, so a send
+ *    is a copy into the ring and an atomic index update with no critical
+ *    section and no kernel queue event list handling. The consumer blocks on a direct-to-task notification
+ *    (notification index 0 of the consumer task) instead of a kernel queue,
+ *    the producer gives the notification after every send.
+ *
+ *    Restrictions compared to TQueue:
+ *      - Exactly one producer context and one consumer task. The consumer task
+ *        is the task that last blocked in Receive / ReceiveWait.
+ *      - Send never blocks, it fails immediately if the ring is full.
+ *      - There is no SendToFront.
+ *      - The consumer task must not use notification index 0 for anything else.
+ *      - T must be trivially copyable.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_INCLUDE_CUBE_CORE_SPSC_QUEUE_H
+#define CUBE_PLUSPLUS_INCLUDE_CUBE_CORE_SPSC_QUEUE_H
+/* Includes ------------------------------------------------------------------*/
+#include <atomic>
+#include <type_traits>
+#include "cmsis_os.h"
+#include "CubeUtils.hpp"
+#include "FreeRTOS.h"
+
+/* Class -----------------------------------------------------------------*/
+/**
+ * @brief Lock-free single-producer single-consumer queue with task notification wakeup
+ *
+ * @tparam T Item type, must be trivially copyable
+ * @tparam SIZE Depth of the queue in number of items
+*/
+template<typename T, const size_t SIZE>
+class SPSCQueue {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "SPSCQueue items must be trivially copyable");
+
+    //Constructors
+    SPSCQueue(void) : writeIndex(0), readIndex(0), consumerTask(nullptr) {}
+
+    //Functions
+    bool Send(T& item);
+    bool SendFromISR(T& item, BaseType_t* pxHigherPriorityTaskWoken = nullptr);    // nullptr yields internally, or pass a flag for one portYIELD_FROM_ISR at the end of the ISR
+
+    bool Receive(T& item, uint32_t timeout_ms = 0);
+    bool ReceiveWait(T& item); //Blocks until an item is received
+
+    //Getters
+    uint16_t GetQueueMessageCount() const;
+    uint16_t GetQueueDepth() const { return SIZE; }
+
+    bool IsEmpty() const { return GetQueueMessageCount() == 0; }
+    bool IsFull() const { return GetQueueMessageCount() == SIZE; }
+
+protected:
+    static constexpr size_t RING_SIZE = SIZE + 1;    // One slot stays free to tell full from empty
+
+    bool Push(const T& item);
+    bool Pop(T& item);
+    bool ReceiveTicks(T& item, TickType_t waitTicks);
+
+    //Data
+    T ring[RING_SIZE];                                // Lock-free ring
+    std::atomic<size_t> writeIndex;                   // Written by the producer only
+    std::atomic<size_t> readIndex;                    // Written by the consumer only
+    std::atomic<TaskHandle_t> consumerTask;           // Task to notify, set when the consumer first blocks
+};
+
+/**
+ * @brief Copies an item into the ring, producer side
+ * @return true on success, false if the ring is full
+*/
+template<typename T, const size_t SIZE>
+bool SPSCQueue<T, SIZE>::Push(const T& item)
+{
+    const size_t write = writeIndex.load(std::memory_order_relaxed);
+    const size_t next = (write + 1 == RING_SIZE) ? 0 : write + 1;
+    if (next == readIndex.load(std::memory_order_acquire))
+        return false;
+
+    ring[write] = item;
+    writeIndex.store(next, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Copies an item out of the ring, consumer side
+ * @return true on success, false if the ring is empty
+*/
+template<typename T, const size_t SIZE>
+bool SPSCQueue<T, SIZE>::Pop(T& item)
+{
+    const size_t read = readIndex.load(std::memory_order_relaxed);
+    if (read == writeIndex.load(std::memory_order_acquire))
+        return false;
+
+    item = ring[read];
+    readIndex.store((read + 1 == RING_SIZE) ? 0 : read + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Number of items in the ring, exact only from the producer or the consumer
+*/
+template<typename T, const size_t SIZE>
+uint16_t SPSCQueue<T, SIZE>::GetQueueMessageCount() const
+{
+    const size_t write = writeIndex.load(std::memory_order_acquire);
+    const size_t read = readIndex.load(std::memory_order_acquire);
+    return static_cast<uint16_t>((write >= read) ? write - read : RING_SIZE - read + write);
+}
+
+/**
+ * @brief Sends an item from task context, never blocks
+ * @param item Item to send
+ * @return true on success, false if the queue is full
+*/
+template<typename T, const size_t SIZE>
+bool SPSCQueue<T, SIZE>::Send(T& item)
+{
+    if (!Push(item))
+        return false;
+
+    TaskHandle_t task = consumerTask.load();
+    if (task != nullptr)
+        xTaskNotifyGive(task);
+
+    return true;
+}
+
+/**
+ * @brief Sends an item from an ISR, never blocks
+ * @param item Item to send
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the consumer was woken and has a higher priority, nullptr (default)
+ *        to request the context switch internally
+ * @return true on success, false if the queue is full
+*/
+template<typename T, const size_t SIZE>
+bool SPSCQueue<T, SIZE>::SendFromISR(T& item, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    if (!Push(item))
+        return false;
+
+    TaskHandle_t task = consumerTask.load();
+    if (task != nullptr) {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(task, &higherPriorityTaskWoken);
+        Utils::YieldFromISR(higherPriorityTaskWoken, pxHigherPriorityTaskWoken);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Polls the queue with a specific timeout, blocks for timeout_ms
+ * @param item Item to receive into
+ * @param timeout_ms Time to block for
+ * @return TRUE if we received an item, FALSE otherwise
+*/
+template<typename T, const size_t SIZE>
+bool SPSCQueue<T, SIZE>::Receive(T& item, uint32_t timeout_ms)
+{
+    return ReceiveTicks(item, MS_TO_TICKS(timeout_ms));
+}
+
+/**
+ * @brief Blocks until an item is received
+ * @param item Item to receive into
+ * @return TRUE if we received an item, FALSE otherwise (should rarely return false)
+*/
+template<typename T, const size_t SIZE>
+bool SPSCQueue<T, SIZE>::ReceiveWait(T& item)
+{
+    return ReceiveTicks(item, HAL_MAX_DELAY);
+}
+
+/**
+ * @brief Receives an item, blocking on the consumer task's notification while the queue is empty
+ * @param item Item to receive into
+ * @param waitTicks Ticks to block for, HAL_MAX_DELAY blocks forever
+ * @return TRUE if we received an item, FALSE on timeout
+*/
+template<typename T, const size_t SIZE>
+bool SPSCQueue<T, SIZE>::ReceiveTicks(T& item, TickType_t waitTicks)
+{
+    if (Pop(item))
+        return true;
+
+    if (waitTicks == 0)
+        return false;
+
+    // Register before re-checking the ring, an item pushed in between then either is seen by the
+    // re-check or leaves a pending notification, so the wakeup cannot be lost
+    consumerTask.store(xTaskGetCurrentTaskHandle());
+
+    const TickType_t startTick = xTaskGetTickCount();
+    TickType_t remainingTicks = waitTicks;
+    while (!Pop(item)) {
+        if (ulTaskNotifyTake(pdTRUE, remainingTicks) == 0)
+            return Pop(item);    // Timed out, take a last look
+
+        // Woken, possibly by a stale notification, recompute the remaining time
+        if (waitTicks != HAL_MAX_DELAY) {
+            const TickType_t elapsedTicks = xTaskGetTickCount() - startTick;
+            if (elapsedTicks >= waitTicks)
+                return Pop(item);
+            remainingTicks = waitTicks - elapsedTicks;
+        }
+    }
+
+    return true;
+}
+
+#endif /* CUBE_PLUSPLUS_INCLUDE_CUBE_CORE_SPSC_QUEUE_H */
@@ -9,112 +9,138 @@
  *    This is an alternative version of Queue.hpp which allows for a template argument,
  *    but due to not using a specific object type it does NOT offer Command class
  *    memory handling capabilities that the dedicated Queue does
+ *
+ *    The queue operations are implemented once in the non-template QueueCore
+ *    on untyped items, TQueue<T> only adds inline typed wrappers
+ *
+ *    StaticTQueue<T, DEPTH> creates the RTOS queue in statically allocated storage
  ******************************************************************************
 */
 #ifndef CUBE_PLUSPLUS_INCLUDE_CUBE_CORE_TQUEUE_H
 #define CUBE_PLUSPLUS_INCLUDE_CUBE_CORE_TQUEUE_H
 /* Includes ------------------------------------------------------------------*/
 #include "cmsis_os.h"
+#include <type_traits>
 #include "Command.hpp"
-#include "CubeUtils.hpp"
+#include "UniqueCommand.hpp"
+#include "QueueCore.hpp"
 #include "FreeRTOS.h"
 
 /* Macros --------------------------------------------------------------------*/
-#define DEFAULT_QUEUE_SEND_WAIT_TICKS (MS_TO_TICKS(15))    // We wait a max of 15ms to send to a queue
+#define DEFAULT_QUEUE_SEND_WAIT_MS 15    // We wait a max of 15ms to send to a queue
+#define DEFAULT_QUEUE_SEND_WAIT_TICKS (MS_TO_TICKS(DEFAULT_QUEUE_SEND_WAIT_MS))
 
 /* Constants -----------------------------------------------------------------*/
 
 /* Class -----------------------------------------------------------------*/
 template<typename T>
-class TQueue {
+class TQueue : public QueueCore {
 public:
     //Constructors
-    TQueue(void);
-    TQueue(uint16_t depth);
+    TQueue(void) : QueueCore(DEFAULT_QUEUE_SIZE, sizeof(T)) {}
+    TQueue(uint16_t depth) : QueueCore(depth, sizeof(T)) {}
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    TQueue(uint16_t depth, uint8_t* rtQueueStorage, StaticQueue_t* rtQueueBuffer)    // Creates the RTOS queue in the given storage, see StaticTQueue
+        : QueueCore(depth, sizeof(T), rtQueueStorage, rtQueueBuffer) {}
+#endif
 
     //Functions
-    bool Send(T& item);
-    bool SendFromISR(T& item);
-
-    bool SendToFront(T& item);
-
-    bool Receive(T& item, uint32_t timeout_ms = 0);
-    bool ReceiveWait(T& item); //Blocks until an item is received
-
-    //Getters
-    uint16_t GetQueueMessageCount() const { return uxQueueMessagesWaiting(rtQueueHandle); }
-    uint16_t GetQueueDepth() const { return queueDepth; }
-
-    bool IsEmpty() const { return GetQueueMessageCount() == 0; }
-    bool IsFull() const { return GetQueueMessageCount() == queueDepth; }
+    bool Send(T& item) { return SendTicks(item, DEFAULT_QUEUE_SEND_WAIT_TICKS, false); }
+    bool SendFromISR(T& item, BaseType_t* pxHigherPriorityTaskWoken = nullptr) { return SendItemFromISR(&item, pxHigherPriorityTaskWoken); }    // nullptr yields internally, or pass a flag for one portYIELD_FROM_ISR at the end of the ISR
+
+    bool SendToFront(T& item) { return SendTicks(item, DEFAULT_QUEUE_SEND_WAIT_TICKS, true); }
+
+    bool Receive(T& item, uint32_t timeout_ms = 0) { return ReceiveTicks(item, MS_TO_TICKS(timeout_ms)); }
+    bool ReceiveWait(T& item) { return ReceiveTicks(item, HAL_MAX_DELAY); } //Blocks until an item is received
+
+    // Batch interface, moves several items per call / wakeup
+    uint16_t SendMany(T items[], uint16_t count) { return SendItems(items, count); }
+    uint16_t ReceiveMany(T items[], uint16_t maxCount, uint32_t timeout_ms = 0) { return ReceiveItems(items, maxCount, MS_TO_TICKS(timeout_ms)); }
+    uint16_t ReceiveManyWait(T items[], uint16_t maxCount) { return ReceiveItems(items, maxCount, HAL_MAX_DELAY); } //Blocks until at least one item is received
+
+    // Owning interface for TQueue<Command>, ownership moves into the queue on success and stays with the caller on failure
+    template<typename U = T, typename = std::enable_if_t<std::is_same<U, Command>::value>>
+    bool Send(UniqueCommand&& item);
+    template<typename U = T, typename = std::enable_if_t<std::is_same<U, Command>::value>>
+    bool SendFromISR(UniqueCommand&& item, BaseType_t* pxHigherPriorityTaskWoken = nullptr);
+    template<typename U = T, typename = std::enable_if_t<std::is_same<U, Command>::value>>
+    bool SendToFront(UniqueCommand&& item);
+    template<typename U = T, typename = std::enable_if_t<std::is_same<U, Command>::value>>
+    bool Receive(UniqueCommand& item, uint32_t timeout_ms = 0);    // Releases any payload item already owns
+    template<typename U = T, typename = std::enable_if_t<std::is_same<U, Command>::value>>
+    bool ReceiveWait(UniqueCommand& item);
 
 protected:
-    //RTOS
-    QueueHandle_t rtQueueHandle;    // RTOS Event Queue Handle
-    
-    //Data
-    uint16_t queueDepth;            // Max queue depth
+    bool SendTicks(T& item, TickType_t waitTicks, bool toFront) { return QueueCore::SendTicks(&item, waitTicks, toFront); }
+    bool ReceiveTicks(T& item, TickType_t waitTicks) { return QueueCore::ReceiveTicks(&item, waitTicks); }
 };
 
 template<typename T>
-TQueue<T>::TQueue(void)
+template<typename U, typename>
+bool TQueue<T>::Send(UniqueCommand&& item)
 {
-    //Initialize RTOS Queue handle
-    rtQueueHandle = xQueueCreate(DEFAULT_QUEUE_SIZE, sizeof(T));
-    queueDepth = 0;
-}
+    if (!Send(item.cmd))
+        return false;
 
-template<typename T>
-TQueue<T>::TQueue(uint16_t depth)
-{
-    //Initialize RTOS Queue handle with given depth
-    rtQueueHandle = xQueueCreate(depth, sizeof(T));
-    queueDepth = depth;
+    item.Disown();
+    return true;
 }
 
 template<typename T>
-bool TQueue<T>::SendFromISR(T& item)
+template<typename U, typename>
+bool TQueue<T>::SendFromISR(UniqueCommand&& item, BaseType_t* pxHigherPriorityTaskWoken)
 {
-    if (xQueueSendFromISR(rtQueueHandle, &item, NULL) == pdPASS)
-        return true;
+    if (!SendFromISR(item.cmd, pxHigherPriorityTaskWoken))
+        return false;
 
-    return false;
+    item.Disown();
+    return true;
 }
 
 template<typename T>
-bool TQueue<T>::SendToFront(T& item)
+template<typename U, typename>
+bool TQueue<T>::SendToFront(UniqueCommand&& item)
 {
-    if (xQueueSendToFront(rtQueueHandle, &item, DEFAULT_QUEUE_SEND_WAIT_TICKS) == pdPASS)
-        return true;
+    if (!SendToFront(item.cmd))
+        return false;
 
-    return false;
+    item.Disown();
+    return true;
 }
 
 template<typename T>
-bool TQueue<T>::Send(T& item)
+template<typename U, typename>
+bool TQueue<T>::Receive(UniqueCommand& item, uint32_t timeout_ms)
 {
-    if (xQueueSend(rtQueueHandle, &item, DEFAULT_QUEUE_SEND_WAIT_TICKS) == pdPASS)
-        return true;
-
-    return false;
+    item.Reset();
+    return Receive(item.cmd, timeout_ms);
 }
 
 template<typename T>
-bool TQueue<T>::Receive(T& item, uint32_t timeout_ms)
+template<typename U, typename>
+bool TQueue<T>::ReceiveWait(UniqueCommand& item)
 {
-    if(xQueueReceive(rtQueueHandle, &item, MS_TO_TICKS(timeout_ms)) == pdTRUE) {
-        return true;
-    }
-    return false;
+    item.Reset();
+    return ReceiveWait(item.cmd);
 }
 
-template<typename T>
-bool TQueue<T>::ReceiveWait(T& item)
-{
-    if (xQueueReceive(rtQueueHandle, &item, HAL_MAX_DELAY) == pdTRUE) {
-        return true;
-    }
-    return false;
-}
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+template<typename T, uint16_t DEPTH>
+class StaticTQueueStorage {
+protected:
+    StaticQueue_t rtQueueBuffer;                  // RTOS queue control block
+    uint8_t rtQueueStorage[DEPTH * sizeof(T)];    // RTOS queue item storage
+};
+
+template<typename T, uint16_t DEPTH = DEFAULT_QUEUE_SIZE>
+class StaticTQueue : private StaticTQueueStorage<T, DEPTH>, public TQueue<T> {
+public:
+    StaticTQueue() : TQueue<T>(DEPTH, this->rtQueueStorage, &this->rtQueueBuffer) {}
+
+private:
+    StaticTQueue(const StaticTQueue&);               // Prevent copy-construction
+    StaticTQueue& operator=(const StaticTQueue&);    // Prevent assignment
+};
+#endif
 
 #endif /* CUBE_PLUSPLUS_INCLUDE_CUBE_CORE_TQUEUE_H */
@@ -9,8 +9,21 @@
 /* Includes ------------------------------------------------------------------*/
 #include <cmsis_os.h>
 #include <Core/Inc/Queue.hpp>
+#include <Core/Inc/TQueue.hpp>
+#include <Core/Inc/PQueue.hpp>
+#include <Core/Inc/Mutex.hpp>
+#include <Core/Inc/CommandMailbox.hpp>
+
+/* User Configurable Defines -------------------------------------------------*/
+#ifndef TASK_MAX_EVENT_SOURCES // Max sources a task can wait on together with a queue set
+#define TASK_MAX_EVENT_SOURCES 4
+#endif
 
 /* Macros --------------------------------------------------------------------*/
+#if (configUSE_QUEUE_SETS == 1)
+// Handler called when a registered source has an item / is available, it must take exactly one item from the source
+typedef void (*TaskEventHandler)(void* context, QueueSetMemberHandle_t source);
+#endif
 
 /* Enums -----------------------------------------------------------------*/
 
@@ -20,7 +33,10 @@ class Task {
 public:
     //Constructors
     Task(void);
-    Task(uint16_t depth);
+    Task(uint16_t depth, QueueItemMode itemMode = QUEUE_ITEM_COMMAND);
+    Task(uint16_t depth, QueueBackpressurePolicy policy, uint32_t sendTimeout_ms = DEFAULT_QUEUE_SEND_WAIT_MS,
+         QueueItemMode itemMode = QUEUE_ITEM_COMMAND);
+    Task(Queue& queue);    // Uses an event queue owned elsewhere (eg. a StaticQueue)
 
     virtual void InitTask() = 0;
 
@@ -28,12 +44,89 @@ public:
     void SendCommand(Command cmd) { qEvtQueue->Send(cmd); }
     void SendCommandReference(Command& cmd) { qEvtQueue->Send(cmd); }
 
+    static uint16_t Broadcast(Command& cmd, Task* const tasks[], uint16_t numTasks);    // Sends one payload to several task event queues without copying it
+
 protected:
+#if (configUSE_QUEUE_SETS == 1)
+    // Multi-source waiting, register every source then call StartEventSet() once, before any source holds items
+    bool AddEventSource(Queue& queue, TaskEventHandler handler, void* context = nullptr);
+    bool AddEventSource(QueueCore& queue, TaskEventHandler handler, void* context = nullptr);    // Any TQueue<T>
+    bool AddEventSource(PQueueCore& queue, TaskEventHandler handler, void* context = nullptr);    // Any PQueue or DeadlineQueue
+    bool AddEventSource(Mutex& mutex, TaskEventHandler handler, void* context = nullptr);
+    bool AddEventSource(CommandMailbox& mailbox, TaskEventHandler handler, void* context = nullptr);
+    bool AddEventSource(QueueSetMemberHandle_t source, uint16_t length, TaskEventHandler handler, void* context = nullptr);
+    bool StartEventSet();
+
+    bool DispatchEvent(uint32_t timeout_ms = 0);    // Waits on every source and calls the handler of the one that fired
+    bool DispatchEventWait();    // Blocks until a source fires
+#endif
+
     //RTOS
     TaskHandle_t rtTaskHandle;        // RTOS Task Handle
 
     //Task structures
     Queue* qEvtQueue;    // Task event queue
+
+#if (configUSE_QUEUE_SETS == 1)
+private:
+    bool DispatchEventTicks(TickType_t waitTicks);
+
+    struct EventSource {
+        QueueSetMemberHandle_t source;
+        uint16_t length;
+        TaskEventHandler handler;
+        void* context;
+    };
+
+    QueueSetHandle_t rtQueueSetHandle;    // RTOS queue set, nullptr until StartEventSet
+    EventSource eventSources[TASK_MAX_EVENT_SOURCES];
+    uint8_t numEventSources;
+#endif
+};
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+/**
+ * @brief Storage of a StaticTask, a separate base class so the event queue is constructed before the Task that uses it
+*/
+template<uint16_t DEPTH, uint32_t STACK_DEPTH_WORDS>
+class StaticTaskStorage {
+protected:
+    StaticQueue<DEPTH> staticEvtQueue;            // Event queue
+    StaticTask_t rtTaskBuffer;                    // RTOS task control block
+    StackType_t rtTaskStack[STACK_DEPTH_WORDS];   // RTOS task stack
+};
+
+/**
+ * @brief Task with a statically allocated event queue, task control block and stack, sized by the template parameters.
+ *        Derived tasks start their RTOS task with CreateStaticTask() instead of xTaskCreate().
+*/
+template<uint16_t DEPTH, uint32_t STACK_DEPTH_WORDS>
+class StaticTask : private StaticTaskStorage<DEPTH, STACK_DEPTH_WORDS>, public Task {
+public:
+    StaticTask() : Task(this->staticEvtQueue) {}
+
+protected:
+    /**
+     * @brief Creates the RTOS task in the static storage
+     * @param taskFunction Static task entry point
+     * @param name Task name
+     * @param params Passed to the task entry point, usually the derived task instance
+     * @param priority RTOS priority
+     * @return TRUE on success, FALSE if the task was already created
+    */
+    bool CreateStaticTask(TaskFunction_t taskFunction, const char* name, void* params, UBaseType_t priority) {
+        if (rtTaskHandle != nullptr)
+            return false;
+
+        rtTaskHandle = xTaskCreateStatic(taskFunction, name, STACK_DEPTH_WORDS, params, priority,
+                                         this->rtTaskStack, &this->rtTaskBuffer);
+        return rtTaskHandle != nullptr;
+    }
+
+private:
+    StaticTask(const StaticTask&);               // Prevent copy-construction
+    StaticTask& operator=(const StaticTask&);    // Prevent assignment
 };
+#endif
 
 #endif /* CUBE_INCLUDE_SOAR_CORE_TASK_H */
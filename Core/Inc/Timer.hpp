@@ -37,6 +37,9 @@ class Timer
 public:
     Timer(); // Default Constructor (Polling Timer)
     Timer(void (*TimerCallbackFunction_t)( TimerHandle_t xTimer )); // Constructor for Callback Enabled Timer
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    Timer(StaticTimer_t* rtTimerBuffer, void (*TimerCallbackFunction_t)( TimerHandle_t xTimer ) = DefaultCallback); // Constructor in the given storage, see StaticTimer
+#endif
     ~Timer();
     bool ChangePeriodMs(const uint32_t period_ms); // Resets timers and initializes period to specified parameters
     bool ChangePeriodMsAndStart(const uint32_t period_ms); // Restarting timer with the specified parameter
@@ -69,6 +72,30 @@ protected:
 
 };
 
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+/**
+ * @brief Storage of a StaticTimer, a separate base class so it is constructed before the Timer that uses it
+*/
+class StaticTimerStorage
+{
+protected:
+    StaticTimer_t rtTimerBuffer; // RTOS timer control block
+};
+
+/**
+ * @brief Timer with a statically allocated RTOS timer
+*/
+class StaticTimer : private StaticTimerStorage, public Timer
+{
+public:
+    StaticTimer() : Timer(&this->rtTimerBuffer, DefaultCallback) {} // Polling Timer
+    StaticTimer(void (*TimerCallbackFunction_t)( TimerHandle_t xTimer )) : Timer(&this->rtTimerBuffer, TimerCallbackFunction_t) {} // Callback Enabled Timer
+
+private:
+    StaticTimer(const StaticTimer&); // Prevent copy-construction, the RTOS timer ID refers to this object
+    StaticTimer& operator=(const StaticTimer&); // Prevent assignment
+};
+#endif
 
 
 #endif /* AVIONICS_INCLUDE_SOAR_CORE_TIMER_H*/
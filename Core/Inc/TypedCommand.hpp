@@ -0,0 +1,187 @@
+/**
+ ******************************************************************************
+ * File Name          : TypedCommand.hpp
+ *
+ * Configuration      : Define macros in SystemDefines.hpp
+ *    #define TYPED_COMMAND_GLOBAL_COMMAND <GLOBAL_COMMANDS> - GLOBAL_COMMANDS
+ *      used by typed Commands, defaults to DATA_COMMAND
+ *
+ * Description        :
+ *    Typed payload Commands. A message type is a trivially copyable struct
+ *    with a constexpr TYPE_ID, the ID is carried in the taskCommand field
+ *    and the struct is constructed in place in the Command payload, which is
+ *    always suitably aligned (pool blocks are max aligned, inline storage is
+ *    pointer aligned), so the receiver reads it through a typed pointer with
+ *    no memcpy.
+ *
+ *    CommandDispatcher<Handler, Types...> generates the dispatch at compile
+ *    time, the received Command is matched against each type's ID and the
+ *    handler's Handle(const T&) overload is called directly.
+ *
+ *    Type IDs share the taskCommand space of the receiving task, they must
+ *    be unique among the types dispatched by one task (checked at compile
+ *    time) and must not collide with that task's untyped taskCommands.
+ *
+ * Example Usage:
+ *    struct ImuReading {
+ *        static constexpr uint16_t TYPE_ID = 0x100;
+ *        float accel[3];
+ *    };
+ *
+ *    SendTypedCommand(*ImuTask::Inst().GetEventQueue(), ImuReading{...});
+ *
+ *    // In the task
+ *    void Handle(const ImuReading& reading);
+ *    ...
+ *    CommandDispatcher<ImuTask, ImuReading, BaroReading>::Dispatch(*this, cm);
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_INCLUDE_CORE_TYPED_COMMAND_H
+#define CUBE_PLUSPLUS_INCLUDE_CORE_TYPED_COMMAND_H
+/* Includes ------------------------------------------------------------------*/
+#include <new>
+#include <type_traits>
+#include "Command.hpp"
+#include "CommandPool.hpp"
+#include "Queue.hpp"
+
+/* User Configurable Defines -------------------------------------------------*/
+#ifndef TYPED_COMMAND_GLOBAL_COMMAND // GLOBAL_COMMANDS used by typed Commands
+#define TYPED_COMMAND_GLOBAL_COMMAND DATA_COMMAND
+#endif
+
+/* Type Checks ---------------------------------------------------------------*/
+/**
+ * @brief Compile time checks for a typed Command payload type
+*/
+template<typename T>
+struct TypedPayloadCheck {
+    static_assert(std::is_trivially_copyable<T>::value, "Typed Command payloads are raw-copied and must be trivially copyable");
+    static_assert(std::is_same<typename std::remove_cv<decltype(T::TYPE_ID)>::type, uint16_t>::value,
+                  "Typed Command payloads must declare static constexpr uint16_t TYPE_ID");
+    static_assert(sizeof(T) <= UINT16_MAX, "Typed Command payload is too large");
+    static_assert(alignof(T) <= COMMAND_POOL_BLOCK_ALIGNMENT, "Typed Command payload is over-aligned for CommandPool blocks");
+    static_assert(sizeof(T) > COMMAND_INLINE_DATA_SIZE || alignof(T) <= alignof(uint8_t*),
+                  "Typed Command payload is stored inline but is over-aligned for inline storage");
+    static constexpr bool value = true;
+};
+
+/* Functions -----------------------------------------------------------------*/
+/**
+ * @brief Checks if a Command carries a payload of the given type
+ * @param cmd Command to check
+ * @return TRUE if the command, type ID and payload size match T
+*/
+template<typename T>
+inline bool IsTypedCommand(const Command& cmd)
+{
+    return cmd.GetCommand() == TYPED_COMMAND_GLOBAL_COMMAND && cmd.GetTaskCommand() == T::TYPE_ID &&
+           cmd.GetDataSize() == sizeof(T);
+}
+
+/**
+ * @brief Sets a typed payload on an empty Command, the payload is copy constructed in place and the
+ *        command and taskCommand are set to TYPED_COMMAND_GLOBAL_COMMAND and T::TYPE_ID
+ * @param cmd Command to set the payload on, must not hold any data
+ * @param payload Payload to copy into the command
+ * @return TRUE on success, FALSE if the command already holds data
+*/
+template<typename T>
+inline bool SetTypedPayload(Command& cmd, const T& payload)
+{
+    static_assert(TypedPayloadCheck<T>::value, "");
+
+    if (cmd.HasData()) {
+        return false;
+    }
+
+    cmd = Command(TYPED_COMMAND_GLOBAL_COMMAND, T::TYPE_ID);
+    ::new (cmd.AllocateData(sizeof(T))) T(payload);
+    return true;
+}
+
+/**
+ * @brief Gets the typed payload of a Command, the payload is read in place
+ * @param cmd Command to read, the pointer is valid until the command is reset (or moved, for inline payloads)
+ * @return Pointer to the payload, nullptr if the command does not carry a T
+*/
+template<typename T>
+inline const T* GetTypedPayload(const Command& cmd)
+{
+    static_assert(TypedPayloadCheck<T>::value, "");
+
+    if (!IsTypedCommand<T>(cmd)) {
+        return nullptr;
+    }
+    return reinterpret_cast<const T*>(cmd.GetDataPointer());
+}
+
+/**
+ * @brief Builds a typed Command and sends it to a queue
+ * @param queue Queue to send to
+ * @param payload Payload to send
+ * @return true on success, false on failure (queue full), the payload is released on failure
+*/
+template<typename T>
+inline bool SendTypedCommand(Queue& queue, const T& payload)
+{
+    Command cmd;
+    SetTypedPayload(cmd, payload);
+    return queue.Send(cmd);
+}
+
+/* Class ---------------------------------------------------------------------*/
+/**
+ * @brief Compile time generated dispatcher for typed Commands
+ *
+ * @tparam Handler Class with a Handle(const T&) overload for each type in Types
+ * @tparam Types Typed payload types handled, their TYPE_IDs must be unique
+*/
+template<typename Handler, typename... Types>
+class CommandDispatcher
+{
+public:
+    static_assert(sizeof...(Types) > 0, "CommandDispatcher needs at least one payload type");
+
+    /**
+     * @brief Calls the handler's Handle overload for the payload type of the command, does not reset the command
+     * @param handler Handler to dispatch to
+     * @param cmd Received command
+     * @return TRUE if the command was dispatched, FALSE if it is not a typed command of one of Types (or the size does not match)
+    */
+    static bool Dispatch(Handler& handler, const Command& cmd) {
+        if (cmd.GetCommand() != TYPED_COMMAND_GLOBAL_COMMAND) {
+            return false;
+        }
+        return (TryDispatch<Types>(handler, cmd) || ...);
+    }
+
+private:
+    template<typename T>
+    static bool TryDispatch(Handler& handler, const Command& cmd) {
+        static_assert(TypedPayloadCheck<T>::value, "");
+
+        if (cmd.GetTaskCommand() != T::TYPE_ID || cmd.GetDataSize() != sizeof(T)) {
+            return false;
+        }
+        handler.Handle(*reinterpret_cast<const T*>(cmd.GetDataPointer()));
+        return true;
+    }
+
+    static constexpr bool UniqueTypeIds() {
+        const uint16_t ids[] = { Types::TYPE_ID... };
+        for (size_t i = 0; i < sizeof...(Types); i++) {
+            for (size_t j = i + 1; j < sizeof...(Types); j++) {
+                if (ids[i] == ids[j]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    static_assert(UniqueTypeIds(), "CommandDispatcher payload types must have unique TYPE_IDs");
+
+    CommandDispatcher();    // Static only
+};
+
+#endif /* CUBE_PLUSPLUS_INCLUDE_CORE_TYPED_COMMAND_H */
@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ * File Name          : UniqueCommand.hpp
+ * Description        :
+ *
+ *    UniqueCommand is a move-only owner of a Command, the payload is released
+ *    (Command::Reset) when the owner is destroyed, so consumers no longer have
+ *    to remember to reset every received Command.
+ *
+ *    Queue, TQueue<Command> and PQueue<Command, SIZE> accept a UniqueCommand
+ *    by rvalue, ownership moves into the queue on success. On failure the
+ *    payload stays with the UniqueCommand (it is not reset), so the sender can
+ *    retry or simply let it go out of scope. Receiving into a UniqueCommand
+ *    hands back an owner.
+ *
+ *    The raw Command API is unchanged and can be mixed with UniqueCommand on
+ *    the same queue, the RTOS queue still only ever holds plain Commands.
+ ******************************************************************************
+*/
+#ifndef CUBE_PLUSPLUS_INCLUDE_CORE_UNIQUE_COMMAND_H
+#define CUBE_PLUSPLUS_INCLUDE_CORE_UNIQUE_COMMAND_H
+/* Includes ------------------------------------------------------------------*/
+#include <cstddef>
+#include "Command.hpp"
+
+class Queue;
+template<typename T> class TQueue;
+template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION> class PQueue;
+
+/* Class -----------------------------------------------------------------*/
+
+/**
+ * @brief UniqueCommand class, move-only owner of a Command that releases the payload on destruction
+ *
+ * Example Usage:
+ *   UniqueCommand cmd(DATA_COMMAND, MY_TASK_COMMAND);
+ *   cmd->CopyDataToCommand(data, size);
+ *   queue.Send(std::move(cmd));
+ *
+ *   UniqueCommand rx;
+ *   if (queue.ReceiveWait(rx)) HandleCommand(*rx);    // Released when rx is reused or destroyed
+*/
+class UniqueCommand
+{
+public:
+    UniqueCommand() {}
+    UniqueCommand(GLOBAL_COMMANDS command, uint16_t taskCommand = 0) : cmd(command, taskCommand) {}
+    explicit UniqueCommand(Command& command);    // Adopts the command, the source is left empty
+    UniqueCommand(UniqueCommand&& other);
+    UniqueCommand& operator=(UniqueCommand&& other);
+    ~UniqueCommand() { cmd.Reset(); }
+
+    // Functions
+    void Reset() { cmd.Reset(); cmd = Command(); }    // Releases the payload, leaves an empty COMMAND_NONE command
+    void Release(Command& target);    // Moves the command out, the caller becomes responsible for resetting it
+
+    // Accessors
+    Command& Get() { return cmd; }
+    const Command& Get() const { return cmd; }
+    Command* operator->() { return &cmd; }
+    const Command* operator->() const { return &cmd; }
+    Command& operator*() { return cmd; }
+    const Command& operator*() const { return cmd; }
+
+private:
+    friend class Queue;
+    template<typename T> friend class TQueue;
+    template<typename T, const size_t SIZE, template<size_t> class ORDER, typename RESERVATION> friend class PQueue;
+
+    void Disown() { cmd = Command(); }    // Forgets the payload without releasing it, ownership has moved elsewhere
+
+    Command cmd;
+
+    UniqueCommand(const UniqueCommand&);               // Prevent copy-construction
+    UniqueCommand& operator=(const UniqueCommand&);    // Prevent assignment
+};
+
+#endif /* CUBE_PLUSPLUS_INCLUDE_CORE_UNIQUE_COMMAND_H */
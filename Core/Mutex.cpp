@@ -21,6 +21,19 @@ Mutex::Mutex()
     CUBE_ASSERT(rtSemaphoreHandle != NULL, "Semaphore creation failed.");
 }
 
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+/**
+ * @brief Constructor for statically allocated mutexes (see StaticMutex).
+ * @param rtSemaphoreBuffer RTOS semaphore control block storage
+ */
+Mutex::Mutex(StaticSemaphore_t* rtSemaphoreBuffer)
+{
+    rtSemaphoreHandle = xSemaphoreCreateMutexStatic(rtSemaphoreBuffer);
+
+    CUBE_ASSERT(rtSemaphoreHandle != NULL, "Semaphore creation failed.");
+}
+#endif
+
 
 /**
  * @brief Destructor for the Mutex class.
@@ -52,19 +65,28 @@ bool Mutex::Unlock()
 
 /**
  * @brief This function is used to lock the Mutex. If calling from ISR this must be used
- * @param timeout_ms The time to wait for the Mutex before it fails. If timeout_ms is not provided, the function will wait indefinitely.
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if a higher priority task was woken, the caller must then call
+ *        portYIELD_FROM_ISR before the ISR exits. If nullptr (default), the context switch is requested internally.
  * @return True on success, false on failure.
 */
-bool Mutex::LockFromISR()
+bool Mutex::LockFromISR(BaseType_t* pxHigherPriorityTaskWoken)
 {
-    return xSemaphoreTakeFromISR(rtSemaphoreHandle, NULL);
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    const bool success = (xSemaphoreTakeFromISR(rtSemaphoreHandle, &higherPriorityTaskWoken) == pdTRUE);
+    Utils::YieldFromISR(higherPriorityTaskWoken, pxHigherPriorityTaskWoken);
+    return success;
 }
 
 /**
  * @brief This function will attempt to unlock the mutex. If calling from ISR this must be used.
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if a higher priority task was woken, the caller must then call
+ *        portYIELD_FROM_ISR before the ISR exits. If nullptr (default), the context switch is requested internally.
  * @return True on success (mutex unlocked) false in failure (mutex was not unlocked)
 */
-bool Mutex::UnlockFromISR()
+bool Mutex::UnlockFromISR(BaseType_t* pxHigherPriorityTaskWoken)
 {
-    return xSemaphoreGiveFromISR(rtSemaphoreHandle, NULL) == pdTRUE;
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    const bool success = (xSemaphoreGiveFromISR(rtSemaphoreHandle, &higherPriorityTaskWoken) == pdTRUE);
+    Utils::YieldFromISR(higherPriorityTaskWoken, pxHigherPriorityTaskWoken);
+    return success;
 }
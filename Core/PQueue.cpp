@@ -0,0 +1,133 @@
+/**
+ ******************************************************************************
+ * File Name          : PQueue.cpp
+ * Description        : Implementation of the type independent PQueue core and buckets
+ ******************************************************************************
+*/
+#include "Core/Inc/PQueue.hpp"
+
+#include "CubeUtils.hpp"
+
+/* Function Implementation ------------------------------------------------------------------*/
+
+/**
+ * @brief Constructor for the PQueueCore class
+ * @param depth Depth of the priority queue
+ * @param freeSlots Slot stack of depth entries, owned by the PQueue
+ */
+PQueueCore::PQueueCore(uint16_t depth, uint16_t* freeSlots)
+{
+    freeSlots_ = freeSlots;
+    numFree_ = 0;
+    depth_ = depth;
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    rtSemaphoreHandle_ = xSemaphoreCreateCountingStatic(depth, 0, &rtSemaphoreBuffer_);
+#else
+    rtSemaphoreHandle_ = xSemaphoreCreateCounting(depth, 0);
+#endif
+    CUBE_ASSERT(rtSemaphoreHandle_ != NULL, "PQueue - semaphore creation failed");
+}
+
+/**
+ * @brief Destructor for the PQueueCore class
+ */
+PQueueCore::~PQueueCore()
+{
+    vSemaphoreDelete(rtSemaphoreHandle_);
+}
+
+/**
+ * @brief Marks every slot free, the highest slot is handed out first
+ */
+void PQueueCore::InitSlots()
+{
+    for(numFree_ = 0; numFree_ < depth_; numFree_++) {
+        freeSlots_[numFree_] = numFree_;
+    }
+}
+
+/**
+ * Signals pushed items to the consumer, one semaphore count per item. Several counts are given with
+ * the scheduler suspended so a waiting receiver is woken once for the batch.
+ *
+ * @param count The number of items to signal.
+ */
+void PQueueCore::SignalItems(uint16_t count) {
+    if(count == 1) {
+        xSemaphoreGive(rtSemaphoreHandle_);
+        return;
+    }
+
+    vTaskSuspendAll();
+    for(uint16_t i = 0; i < count; i++) {
+        xSemaphoreGive(rtSemaphoreHandle_);
+    }
+    xTaskResumeAll();
+}
+
+/**
+ * Signals one pushed item to the consumer from an ISR.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if a higher priority task was woken, nullptr to request the
+ *        context switch internally.
+ */
+void PQueueCore::SignalItemFromISR(BaseType_t* pxHigherPriorityTaskWoken) {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    xSemaphoreGiveFromISR(rtSemaphoreHandle_, &higherPriorityTaskWoken);
+    Utils::YieldFromISR(higherPriorityTaskWoken, pxHigherPriorityTaskWoken);
+}
+
+/**
+ * Appends a slot to the bucket of its priority.
+ *
+ * @param slot The item slot.
+ * @param priority The priority of the item.
+ */
+void PQueueBuckets::Push(uint16_t slot, uint8_t priority) {
+    const uint8_t word = priority >> 5;
+    const uint32_t bit = 1UL << (priority & 31);
+
+    if(bitmap_[word] & bit) {
+        // Insert after the tail, the new slot links back to the head
+        const uint16_t tail = tails_[priority];
+        next_[slot] = next_[tail];
+        next_[tail] = slot;
+    }
+    else {
+        // First slot of the bucket links to itself
+        next_[slot] = slot;
+        bitmap_[word] |= bit;
+        summary_ |= (1U << word);
+    }
+    tails_[priority] = slot;
+    size_ += 1;
+}
+
+/**
+ * Pops the oldest slot of the highest occupied priority, the buckets must not be empty.
+ *
+ * @return The item slot.
+ */
+uint16_t PQueueBuckets::Pop() {
+    // Highest set bit of the summary then of its bitmap word
+    const uint8_t word = static_cast<uint8_t>(31 - __builtin_clz(summary_));
+    const uint8_t priority = static_cast<uint8_t>((word << 5) | (31 - __builtin_clz(bitmap_[word])));
+
+    const uint16_t tail = tails_[priority];
+    const uint16_t head = next_[tail];
+
+    if(head == tail) {
+        // Last slot of the bucket
+        bitmap_[word] &= ~(1UL << (priority & 31));
+        if(bitmap_[word] == 0) {
+            summary_ &= ~(1U << word);
+        }
+    }
+    else {
+        next_[tail] = next_[head];
+    }
+    size_ -= 1;
+
+    return head;
+}
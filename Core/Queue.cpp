@@ -18,29 +18,81 @@ Queue::Queue(void)
 {
     //Initialize RTOS Queue handle
     rtQueueHandle = xQueueCreate(DEFAULT_QUEUE_SIZE, sizeof(Command));
-    queueDepth = 0;
+    queueDepth = DEFAULT_QUEUE_SIZE;
+    itemMode = QUEUE_ITEM_COMMAND;
+    policy = QUEUE_POLICY_BLOCK;
+    sendWaitTicks = DEFAULT_QUEUE_SEND_WAIT_TICKS;
 }
 
 /**
  * @brief Constructor with depth for the Queue class
  * @param depth Queue depth
+ * @param itemMode QUEUE_ITEM_COMMAND (default) to queue full Command objects, QUEUE_ITEM_HANDLE to
+ *        queue CommandSlotTable handles only
 */
-Queue::Queue(uint16_t depth)
+Queue::Queue(uint16_t depth, QueueItemMode itemMode)
 {
     //Initialize RTOS Queue handle with given depth
-    rtQueueHandle = xQueueCreate(depth, sizeof(Command));
+    rtQueueHandle = xQueueCreate(depth, GetQueueItemSize(itemMode));
     queueDepth = depth;
+    this->itemMode = itemMode;
+    policy = QUEUE_POLICY_BLOCK;
+    sendWaitTicks = DEFAULT_QUEUE_SEND_WAIT_TICKS;
 }
 
+/**
+ * @brief Constructor with depth and backpressure policy for the Queue class
+ * @param depth Queue depth
+ * @param policy What Send does when the queue is full
+ * @param sendTimeout_ms Time Send waits for space with QUEUE_POLICY_BLOCK
+ * @param itemMode QUEUE_ITEM_COMMAND (default) to queue full Command objects, QUEUE_ITEM_HANDLE to
+ *        queue CommandSlotTable handles only
+*/
+Queue::Queue(uint16_t depth, QueueBackpressurePolicy policy, uint32_t sendTimeout_ms, QueueItemMode itemMode) :
+    Queue(depth, itemMode)
+{
+    this->policy = policy;
+    sendWaitTicks = MS_TO_TICKS(sendTimeout_ms);
+    CheckPolicyDepth();
+}
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+/**
+ * @brief Constructor for statically allocated queues, creates the RTOS queue in the given storage (see StaticQueue)
+ * @param depth Queue depth
+ * @param rtQueueStorage Item storage, at least depth * GetQueueItemSize(itemMode) bytes
+ * @param rtQueueBuffer RTOS queue control block storage
+ * @param itemMode What the RTOS queue stores for each Command
+ * @param policy What Send does when the queue is full
+ * @param sendTimeout_ms Time Send waits for space with QUEUE_POLICY_BLOCK
+*/
+Queue::Queue(uint16_t depth, uint8_t* rtQueueStorage, StaticQueue_t* rtQueueBuffer, QueueItemMode itemMode,
+             QueueBackpressurePolicy policy, uint32_t sendTimeout_ms)
+{
+    rtQueueHandle = xQueueCreateStatic(depth, GetQueueItemSize(itemMode), rtQueueStorage, rtQueueBuffer);
+    CUBE_ASSERT(rtQueueHandle != nullptr, "Queue - xQueueCreateStatic() failed");
+    queueDepth = depth;
+    this->itemMode = itemMode;
+    this->policy = policy;
+    sendWaitTicks = MS_TO_TICKS(sendTimeout_ms);
+    CheckPolicyDepth();
+}
+#endif
+
 /**
  * @brief Sends a command object to the queue, safe to call from ISR
  * @param command Command object reference to send
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the send woke a higher priority task, the caller must then call
+ *        portYIELD_FROM_ISR before the ISR exits. If nullptr (default), the context switch is requested internally.
  * @return true on success, false on failure (queue full)
 */
-bool Queue::SendFromISR(Command& command)
+bool Queue::SendFromISR(Command& command, BaseType_t* pxHigherPriorityTaskWoken)
 {
-    //Note: There NULL param here could be used to wake a task right after after exiting the ISR
-    if (xQueueSendFromISR(rtQueueHandle, &command, NULL) == pdPASS)
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    const bool success = SendWithPolicy(command, &higherPriorityTaskWoken);
+    Utils::YieldFromISR(higherPriorityTaskWoken, pxHigherPriorityTaskWoken);
+
+    if (success)
         return true;
 
     command.Reset();
@@ -56,7 +108,7 @@ bool Queue::SendFromISR(Command& command)
 bool Queue::SendToFront(Command& command)
 {
     //Send to the back of the queue
-    if (xQueueSendToFront(rtQueueHandle, &command, DEFAULT_QUEUE_SEND_WAIT_TICKS) == pdPASS)
+    if (SendToFrontWithPolicy(command))
         return true;
 
     CUBE_PRINT("Could not send data to front of queue!\n");
@@ -76,7 +128,7 @@ bool Queue::SendToFront(Command& command)
 */
 bool Queue::Send(Command& command, bool reportFull)
 {
-    if (xQueueSend(rtQueueHandle, &command, DEFAULT_QUEUE_SEND_WAIT_TICKS) == pdPASS)
+    if (SendWithPolicy(command, nullptr))
         return true;
 
     if (reportFull) CUBE_PRINT("Could not send data to queue!\n");
@@ -94,7 +146,7 @@ bool Queue::Send(Command& command, bool reportFull)
 */
 bool Queue::Receive(Command& cm, uint32_t timeout_ms)
 {
-    if(xQueueReceive(rtQueueHandle, &cm, MS_TO_TICKS(timeout_ms)) == pdTRUE) {
+    if(ReceiveItem(cm, MS_TO_TICKS(timeout_ms))) {
         return true;
     }
     return false;
@@ -107,8 +159,457 @@ bool Queue::Receive(Command& cm, uint32_t timeout_ms)
 */
 bool Queue::ReceiveWait(Command& cm)
 {
-    if (xQueueReceive(rtQueueHandle, &cm, HAL_MAX_DELAY) == pdTRUE) {
+    if (ReceiveItem(cm, HAL_MAX_DELAY)) {
         return true;
     }
     return false;
 }
+
+/**
+ * @brief Sends several command objects to the queue in FIFO order. The scheduler is suspended while the commands
+ *        that fit are sent, so a waiting receiver is woken once and sees the whole batch instead of being switched
+ *        to after every item.
+ *        The batch is not sent in one interrupt masked critical section as PQueue::SendMany does: each RTOS queue
+ *        send copies the Command inside its own kernel critical section, task level sends must not be called with
+ *        interrupts masked, and holding the mask for N copies would add to the interrupt latency. ISRs may
+ *        therefore interleave their own sends with the batch.
+ *        The commands that did not fit then go through the backpressure policy one by one, with the scheduler
+ *        running. BLOCK waits for space and FAIL_FAST drops, once a command is dropped the rest of the batch
+ *        is dropped too. The replacing policies release queued commands as Send does, COALESCE drops each
+ *        command without a match on its own.
+ * @param commands Array of commands to send
+ * @param count Number of commands in the array
+ * @param reportFull If true (default), prints an error message if a command is dropped
+ * @return Number of commands sent. With BLOCK and FAIL_FAST the first commands of the array are the ones sent.
+*/
+uint16_t Queue::SendMany(Command commands[], uint16_t count, bool reportFull)
+{
+    uint16_t numSent = 0;
+    uint16_t next = 0;
+
+    vTaskSuspendAll();
+    while (next < count && SendItem(commands[next], 0, false)) {
+        next++;
+        QUEUE_STATS_SEND_NO_WAIT(true, GetQueueMessageCount());
+    }
+    xTaskResumeAll();
+    numSent = next;
+
+    // The queue is full, apply the policy to the remaining commands
+    const bool replacing = (policy == QUEUE_POLICY_DROP_OLDEST || policy == QUEUE_POLICY_OVERWRITE_NEWEST ||
+                            policy == QUEUE_POLICY_COALESCE);
+    uint16_t numDropped = 0;
+    for (; next < count; next++) {
+        if (SendWithPolicy(commands[next], nullptr)) {
+            numSent++;
+            continue;
+        }
+
+        numDropped++;
+        commands[next].Reset();
+        if (!replacing)
+            break;
+    }
+
+    // Commands after a BLOCK / FAIL_FAST drop are not attempted
+    if (next < count) {
+        CountDrop(dropCounters.droppedNew, count - next - 1);
+        for (uint16_t i = next + 1; i < count; i++) {
+            QUEUE_STATS_SEND_NO_WAIT(false, queueDepth);
+            commands[i].Reset();
+        }
+    }
+
+    if (reportFull && numDropped > 0) CUBE_PRINT("Could not send data to queue!\n");
+
+    return numSent;
+}
+
+/**
+ * @brief Receives up to maxCount commands, blocks for timeout_ms for the first command then takes every
+ *        command that is already queued without blocking again
+ * @param cms Array of Command objects to copy received data into
+ * @param maxCount Size of the array
+ * @param timeout_ms Time to block for the first command
+ * @return Number of commands received
+*/
+uint16_t Queue::ReceiveMany(Command cms[], uint16_t maxCount, uint32_t timeout_ms)
+{
+    if (maxCount == 0 || !ReceiveItem(cms[0], MS_TO_TICKS(timeout_ms)))
+        return 0;
+
+    uint16_t numReceived = 1;
+    while (numReceived < maxCount && ReceiveItem(cms[numReceived], 0)) {
+        numReceived++;
+    }
+    return numReceived;
+}
+
+/**
+ * @brief Receives up to maxCount commands, blocks forever for the first command then takes every
+ *        command that is already queued without blocking again
+ * @param cms Array of Command objects to copy received data into
+ * @param maxCount Size of the array
+ * @return Number of commands received (should rarely return 0)
+*/
+uint16_t Queue::ReceiveManyWait(Command cms[], uint16_t maxCount)
+{
+    if (maxCount == 0 || !ReceiveItem(cms[0], HAL_MAX_DELAY))
+        return 0;
+
+    uint16_t numReceived = 1;
+    while (numReceived < maxCount && ReceiveItem(cms[numReceived], 0)) {
+        numReceived++;
+    }
+    return numReceived;
+}
+
+/**
+ * @brief Sends an owned command to the queue (sends to back of queue in FIFO order), ownership moves into
+ *        the queue on success. On failure the command is NOT reset, it stays owned by the caller.
+ * @param command Owned command to send
+ * @param reportFull If true (default), prints an error message if the queue is full
+ * @return true on success, false on failure (queue full)
+*/
+bool Queue::Send(UniqueCommand&& command, bool reportFull)
+{
+    if (SendWithPolicy(command.cmd, nullptr)) {
+        command.Disown();
+        return true;
+    }
+
+    if (reportFull) CUBE_PRINT("Could not send data to queue!\n");
+    return false;
+}
+
+/**
+ * @brief Sends an owned command to the queue, safe to call from ISR. On failure the command stays owned by the caller.
+ * @param command Owned command to send
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the send woke a higher priority task, nullptr (default) to
+ *        request the context switch internally
+ * @return true on success, false on failure (queue full)
+*/
+bool Queue::SendFromISR(UniqueCommand&& command, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    const bool success = SendWithPolicy(command.cmd, &higherPriorityTaskWoken);
+    Utils::YieldFromISR(higherPriorityTaskWoken, pxHigherPriorityTaskWoken);
+
+    if (success) {
+        command.Disown();
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Sends an owned command to the front of the queue. On failure the command stays owned by the caller.
+ * @param command Owned command to send
+ * @return true on success, false on failure (queue full)
+*/
+bool Queue::SendToFront(UniqueCommand&& command)
+{
+    if (SendToFrontWithPolicy(command.cmd)) {
+        command.Disown();
+        return true;
+    }
+
+    CUBE_PRINT("Could not send data to front of queue!\n");
+    return false;
+}
+
+/**
+ * @brief Polls queue with specific timeout into an owner, any payload the owner held is released first
+ * @param cm Owner to receive the command into
+ * @param timeout_ms Time to block for
+ * @return TRUE if we received a command, FALSE otherwise (cm is left empty)
+*/
+bool Queue::Receive(UniqueCommand& cm, uint32_t timeout_ms)
+{
+    cm.Reset();
+    return ReceiveItem(cm.cmd, MS_TO_TICKS(timeout_ms));
+}
+
+/**
+ * @brief Blocks forever until a command is received into an owner, any payload the owner held is released first
+ * @param cm Owner to receive the command into
+ * @return TRUE if we received a command, FALSE otherwise (should rarely return false)
+*/
+bool Queue::ReceiveWait(UniqueCommand& cm)
+{
+    cm.Reset();
+    return ReceiveItem(cm.cmd, HAL_MAX_DELAY);
+}
+
+/**
+ * @brief Sends a command to the RTOS queue in the queue's item mode, does not reset the command on failure
+ * @param command Command object reference to send
+ * @param waitTicks Ticks to wait for space in the queue
+ * @param toFront If true, sends to the front of the queue
+ * @return true on success, false on failure (queue or slot table full)
+*/
+bool Queue::SendItem(Command& command, TickType_t waitTicks, bool toFront)
+{
+    COMMAND_TRACE_STAMP(command);
+
+    // In handle mode the command is parked in the slot table and only the handle is queued
+    CommandHandle_t handle = COMMAND_HANDLE_INVALID;
+    const void* item = &command;
+    if (itemMode == QUEUE_ITEM_HANDLE) {
+        handle = CommandSlotTable::Store(command);
+        item = &handle;
+    }
+
+    bool success = false;
+    if (itemMode == QUEUE_ITEM_COMMAND || handle != COMMAND_HANDLE_INVALID) {
+        const BaseType_t result = toFront ? xQueueSendToFront(rtQueueHandle, item, waitTicks)
+                                          : xQueueSend(rtQueueHandle, item, waitTicks);
+        success = (result == pdPASS);
+    }
+
+    // Move the command back out of the table so the caller can reset it
+    if (!success && handle != COMMAND_HANDLE_INVALID)
+        CommandSlotTable::Take(handle, command);
+
+    return success;
+}
+
+/**
+ * @brief Sends a command to the RTOS queue in the queue's item mode from an ISR, does not reset the command on failure
+ * @param command Command object reference to send
+ * @param higherPriorityTaskWoken Set to pdTRUE if the send woke a higher priority task
+ * @return true on success, false on failure (queue or slot table full)
+*/
+bool Queue::SendItemFromISR(Command& command, BaseType_t* higherPriorityTaskWoken)
+{
+    COMMAND_TRACE_STAMP(command);
+
+    CommandHandle_t handle = COMMAND_HANDLE_INVALID;
+    const void* item = &command;
+    if (itemMode == QUEUE_ITEM_HANDLE) {
+        handle = CommandSlotTable::Store(command);
+        item = &handle;
+    }
+
+    bool success = false;
+    if (itemMode == QUEUE_ITEM_COMMAND || handle != COMMAND_HANDLE_INVALID)
+        success = (xQueueSendFromISR(rtQueueHandle, item, higherPriorityTaskWoken) == pdPASS);
+
+    if (!success && handle != COMMAND_HANDLE_INVALID)
+        CommandSlotTable::Take(handle, command);
+
+    return success;
+}
+
+/**
+ * @brief Receives a command from the RTOS queue in the queue's item mode
+ * @param cm Command object to copy received data into
+ * @param waitTicks Ticks to block for
+ * @return TRUE if we received a command, FALSE otherwise (timeout or stale handle)
+*/
+bool Queue::ReceiveItem(Command& cm, TickType_t waitTicks)
+{
+    QUEUE_STATS_BEGIN();
+
+    bool success;
+    if (itemMode == QUEUE_ITEM_COMMAND) {
+        success = (xQueueReceive(rtQueueHandle, &cm, waitTicks) == pdTRUE);
+    }
+    else {
+        CommandHandle_t handle;
+        success = (xQueueReceive(rtQueueHandle, &handle, waitTicks) == pdTRUE);
+
+        if (success && !CommandSlotTable::Take(handle, cm)) {
+            CUBE_PRINT("Queue received a stale Command handle!\n");
+            success = false;
+        }
+    }
+
+    QUEUE_STATS_RECEIVE(success);
+    if (success)
+        COMMAND_TRACE_DEQUEUE(cm);
+    return success;
+}
+
+/**
+ * @brief Sends a command to the back of the queue according to the backpressure policy, does not reset the
+ *        command on failure
+ * @param command Command object reference to send
+ * @param isrTaskWoken nullptr in task context, in an ISR the send never blocks and this collects the higher priority task woken flag
+ * @return true on success, false if the command was dropped
+*/
+bool Queue::SendWithPolicy(Command& command, BaseType_t* isrTaskWoken)
+{
+    // When the queue is full, the replacing policies make room by releasing a queued command
+    const bool replacing = (policy == QUEUE_POLICY_DROP_OLDEST || policy == QUEUE_POLICY_OVERWRITE_NEWEST ||
+                            policy == QUEUE_POLICY_COALESCE);
+
+    // One stats record per send, whether the first attempt or the replacing send queued the command
+    bool success;
+    if (isrTaskWoken != nullptr) {
+        success = SendItemFromISR(command, isrTaskWoken) || (replacing && SendReplacing(command, isrTaskWoken));
+        QUEUE_STATS_SEND_NO_WAIT(success, uxQueueMessagesWaitingFromISR(rtQueueHandle));
+    }
+    else {
+        QUEUE_STATS_BEGIN();
+        success = SendItem(command, (policy == QUEUE_POLICY_BLOCK) ? sendWaitTicks : 0, false) ||
+                  (replacing && SendReplacing(command, nullptr));
+        QUEUE_STATS_SEND(success, GetQueueMessageCount());
+    }
+
+    if (!success)
+        CountDrop(dropCounters.droppedNew);
+    return success;
+}
+
+/**
+ * @brief Sends a command to the front of the queue, the replacing policies never release queued
+ *        commands for a command jumping the queue so they behave as QUEUE_POLICY_FAIL_FAST
+ * @param command Command object reference to send
+ * @return true on success, false if the command was dropped
+*/
+bool Queue::SendToFrontWithPolicy(Command& command)
+{
+    QUEUE_STATS_BEGIN();
+
+    const bool success = SendItem(command, (policy == QUEUE_POLICY_BLOCK) ? sendWaitTicks : 0, true);
+    QUEUE_STATS_SEND(success, GetQueueMessageCount());
+
+    if (!success)
+        CountDrop(dropCounters.droppedNew);
+    return success;
+}
+
+/**
+ * @brief Puts a command into a full queue in place of a queued command, according to the replacing
+ *        backpressure policy. The queue is modified in an interrupt mask critical section so no other
+ *        sender or receiver sees it partially rotated, with the non-blocking FromISR queue API as the task API
+ *        must not be called with interrupts masked. DROP_OLDEST takes one item out, OVERWRITE_NEWEST and
+ *        COALESCE rotate at most QUEUE_REPLACING_MAX_DEPTH items. Released commands are reset after the
+ *        critical section.
+ * @param command Command object reference to send
+ * @param isrTaskWoken nullptr in task context, in an ISR this collects the higher priority task woken flag
+ * @return true if the command was queued, false if it was dropped (COALESCE without a match, or slot table full)
+*/
+bool Queue::SendReplacing(Command& command, BaseType_t* isrTaskWoken)
+{
+    CommandHandle_t handle = COMMAND_HANDLE_INVALID;
+    const void* item = &command;
+    if (itemMode == QUEUE_ITEM_HANDLE) {
+        handle = CommandSlotTable::Store(command);
+        if (handle == COMMAND_HANDLE_INVALID)
+            return false;
+        item = &handle;
+    }
+
+    // Queued items are rotated through one of these depending on the item mode
+    Command queuedCommand;
+    CommandHandle_t queuedHandle = COMMAND_HANDLE_INVALID;
+    void* queuedItem = (itemMode == QUEUE_ITEM_HANDLE) ? static_cast<void*>(&queuedHandle) : static_cast<void*>(&queuedCommand);
+
+    bool replaced = false;
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+
+    // A receiver may have made space since the caller's send failed
+    bool sent = (xQueueSendFromISR(rtQueueHandle, item, &higherPriorityTaskWoken) == pdPASS);
+
+    if (sent) {
+        // Nothing to replace
+    }
+    else if (policy == QUEUE_POLICY_DROP_OLDEST) {
+        if (xQueueReceiveFromISR(rtQueueHandle, queuedItem, &higherPriorityTaskWoken) == pdTRUE) {
+            xQueueSendFromISR(rtQueueHandle, item, &higherPriorityTaskWoken);    // Cannot fail, a space was just freed
+            dropCounters.droppedOldest += 1;
+            replaced = sent = true;
+        }
+    }
+    else {
+        // Rotate every queued item once to keep the FIFO order, the new command takes the place of the replaced item
+        const UBaseType_t count = uxQueueMessagesWaitingFromISR(rtQueueHandle);
+        Command matched;
+        CommandHandle_t matchedHandle = COMMAND_HANDLE_INVALID;
+        for (UBaseType_t i = 0; i < count; i++) {
+            xQueueReceiveFromISR(rtQueueHandle, queuedItem, &higherPriorityTaskWoken);
+
+            const bool replaceThis = !replaced &&
+                ((policy == QUEUE_POLICY_OVERWRITE_NEWEST) ? (i == count - 1) : IsCoalesceMatch(queuedItem, command));
+            if (replaceThis) {
+                matched = queuedCommand;
+                matchedHandle = queuedHandle;
+                replaced = sent = true;
+            }
+            xQueueSendFromISR(rtQueueHandle, replaceThis ? item : queuedItem, &higherPriorityTaskWoken);
+        }
+
+        queuedCommand = matched;
+        queuedHandle = matchedHandle;
+        if (replaced) {
+            if (policy == QUEUE_POLICY_OVERWRITE_NEWEST)
+                dropCounters.overwritten += 1;
+            else
+                dropCounters.coalesced += 1;
+        }
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    if (replaced) {
+        // Release the payload of the command that was pushed out
+        if (itemMode == QUEUE_ITEM_HANDLE)
+            CommandSlotTable::Take(queuedHandle, queuedCommand);
+        queuedCommand.Reset();
+    }
+    if (!sent && handle != COMMAND_HANDLE_INVALID)
+        CommandSlotTable::Take(handle, command);
+
+    // In an ISR the context switch is left to the caller of the FromISR API
+    if (isrTaskWoken != nullptr) {
+        if (higherPriorityTaskWoken == pdTRUE) *isrTaskWoken = pdTRUE;
+    }
+    else if (higherPriorityTaskWoken == pdTRUE) {
+        taskYIELD();
+    }
+
+    return sent;
+}
+
+/**
+ * @brief Checks if a queued item carries the same GLOBAL_COMMANDS / taskCommand pair as a command, must be
+ *        called in a critical section in handle mode
+ * @param queuedItem Item received from the RTOS queue in the queue's item mode
+ * @param command Command to compare against
+ * @return true if the queued command can be coalesced with the command
+*/
+bool Queue::IsCoalesceMatch(const void* queuedItem, const Command& command) const
+{
+    const Command* queued = static_cast<const Command*>(queuedItem);
+    if (itemMode == QUEUE_ITEM_HANDLE)
+        queued = CommandSlotTable::Peek(*static_cast<const CommandHandle_t*>(queuedItem));
+
+    return queued != nullptr && queued->GetCommand() == command.GetCommand() &&
+           queued->GetTaskCommand() == command.GetTaskCommand();
+}
+
+/**
+ * @brief Adds to a drop counter, safe to call from an ISR
+ * @param counter Counter in dropCounters
+ * @param count Number of drops
+*/
+void Queue::CountDrop(uint32_t& counter, uint32_t count)
+{
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    counter += count;
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+}
+
+/**
+ * @brief Asserts the depth of a queue whose replacing policy rotates the queue (OVERWRITE_NEWEST, COALESCE) is
+ *        at most QUEUE_REPLACING_MAX_DEPTH, the rotation runs with interrupts masked
+*/
+void Queue::CheckPolicyDepth() const
+{
+    const bool rotating = (policy == QUEUE_POLICY_OVERWRITE_NEWEST || policy == QUEUE_POLICY_COALESCE);
+    CUBE_ASSERT(!rotating || queueDepth <= QUEUE_REPLACING_MAX_DEPTH,
+                "Queue - OVERWRITE_NEWEST / COALESCE depth exceeds QUEUE_REPLACING_MAX_DEPTH");
+}
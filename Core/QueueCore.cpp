@@ -0,0 +1,137 @@
+/**
+ ******************************************************************************
+ * File Name          : QueueCore.cpp
+ * Description        : Implementation of the type-erased TQueue core
+ ******************************************************************************
+*/
+#include "Core/Inc/QueueCore.hpp"
+
+#include "CubeUtils.hpp"
+#include "SystemDefines.hpp"
+
+/* Function Implementation ------------------------------------------------------------------*/
+
+/**
+ * @brief Constructor for the QueueCore class
+ * @param depth Queue depth
+ * @param itemSize Size of one item in bytes
+*/
+QueueCore::QueueCore(uint16_t depth, uint16_t itemSize)
+{
+    //Initialize RTOS Queue handle with given depth
+    rtQueueHandle = xQueueCreate(depth, itemSize);
+    queueDepth = depth;
+    this->itemSize = itemSize;
+}
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+/**
+ * @brief Constructor for statically allocated queues, creates the RTOS queue in the given storage
+ * @param depth Queue depth
+ * @param itemSize Size of one item in bytes
+ * @param rtQueueStorage Item storage of at least depth * itemSize bytes
+ * @param rtQueueBuffer RTOS queue control block
+*/
+QueueCore::QueueCore(uint16_t depth, uint16_t itemSize, uint8_t* rtQueueStorage, StaticQueue_t* rtQueueBuffer)
+{
+    //Initialize RTOS Queue handle in the given storage
+    rtQueueHandle = xQueueCreateStatic(depth, itemSize, rtQueueStorage, rtQueueBuffer);
+    queueDepth = depth;
+    this->itemSize = itemSize;
+}
+#endif
+
+/**
+ * @brief Sends an item to the queue, blocks for waitTicks if the queue is full
+ * @param item Item to copy into the queue
+ * @param waitTicks Ticks to block for
+ * @param toFront If true the item is sent to the front of the queue
+ * @return true on success, false if the queue stayed full
+*/
+bool QueueCore::SendTicks(const void* item, TickType_t waitTicks, bool toFront)
+{
+    QUEUE_STATS_BEGIN();
+
+    const BaseType_t result = toFront ? xQueueSendToFront(rtQueueHandle, item, waitTicks)
+                                      : xQueueSend(rtQueueHandle, item, waitTicks);
+    const bool success = (result == pdPASS);
+
+    QUEUE_STATS_SEND(success, GetQueueMessageCount());
+    return success;
+}
+
+/**
+ * @brief Sends an item to the back of the queue, safe to call from ISR
+ * @param item Item to copy into the queue
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the send woke a higher priority task, nullptr to request the
+ *        context switch internally
+ * @return true on success, false if the queue is full
+*/
+bool QueueCore::SendItemFromISR(const void* item, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    const bool success = (xQueueSendFromISR(rtQueueHandle, item, &higherPriorityTaskWoken) == pdPASS);
+
+    QUEUE_STATS_SEND_NO_WAIT(success, uxQueueMessagesWaitingFromISR(rtQueueHandle));
+    Utils::YieldFromISR(higherPriorityTaskWoken, pxHigherPriorityTaskWoken);
+    return success;
+}
+
+/**
+ * @brief Receives an item from the queue, blocks for waitTicks if the queue is empty
+ * @param item Buffer of itemSize bytes to copy the item into
+ * @param waitTicks Ticks to block for
+ * @return TRUE if we received an item, FALSE otherwise
+*/
+bool QueueCore::ReceiveTicks(void* item, TickType_t waitTicks)
+{
+    QUEUE_STATS_BEGIN();
+
+    const bool success = (xQueueReceive(rtQueueHandle, item, waitTicks) == pdTRUE);
+
+    QUEUE_STATS_RECEIVE(success);
+    return success;
+}
+
+/**
+ * @brief Sends as many items as fit without blocking, a waiting receiver is woken once for the whole batch
+ * @param items Array of count packed items
+ * @param count Number of items
+ * @return Number of items sent, the first items of the array are always the ones sent
+*/
+uint16_t QueueCore::SendItems(const void* items, uint16_t count)
+{
+    const uint8_t* item = static_cast<const uint8_t*>(items);
+    uint16_t numSent = 0;
+
+    // The scheduler is suspended so a waiting receiver is woken once for the whole batch, sends cannot block
+    vTaskSuspendAll();
+    while (numSent < count && SendTicks(item, 0, false)) {
+        item += itemSize;
+        numSent++;
+    }
+    xTaskResumeAll();
+
+    return numSent;
+}
+
+/**
+ * @brief Receives up to maxCount items, blocks for waitTicks for the first item then takes every queued item
+ * @param items Array of maxCount packed items to copy the items into
+ * @param maxCount Size of the array
+ * @param waitTicks Ticks to block for the first item
+ * @return Number of items received
+*/
+uint16_t QueueCore::ReceiveItems(void* items, uint16_t maxCount, TickType_t waitTicks)
+{
+    uint8_t* item = static_cast<uint8_t*>(items);
+
+    if (maxCount == 0 || !ReceiveTicks(item, waitTicks))
+        return 0;
+
+    uint16_t numReceived = 1;
+    while (numReceived < maxCount && ReceiveTicks(item + numReceived * itemSize, 0)) {
+        numReceived++;
+    }
+    return numReceived;
+}
@@ -0,0 +1,88 @@
+/**
+ ******************************************************************************
+ * File Name          : QueueStats.cpp
+ * Description        : Implementation of the per queue statistics
+ ******************************************************************************
+*/
+#include "Core/Inc/QueueStats.hpp"
+
+#include "CubeDefines.hpp"
+#include "SystemDefines.hpp"
+
+#ifdef QUEUE_INSTRUMENTATION
+
+/**
+ * @brief Records a send attempt. Safe to call from an ISR.
+ * @param success True if the item was queued
+ * @param blockedTicks Time the sender spent in the send call
+ * @param count Number of items in the queue after the send
+*/
+void QueueStats::RecordSend(bool success, TickType_t blockedTicks, uint16_t count)
+{
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+
+    if (success) {
+        sendCount += 1;
+        if (count > peakDepth) {
+            peakDepth = count;
+        }
+    }
+    else {
+        sendFailures += 1;
+    }
+
+    sendBlockTicks += blockedTicks;
+    if (blockedTicks > maxSendBlockTicks) {
+        maxSendBlockTicks = blockedTicks;
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+}
+
+/**
+ * @brief Records a receive attempt. Safe to call from an ISR.
+ * @param success True if an item was received
+ * @param waitedTicks Time the consumer spent in the receive call
+*/
+void QueueStats::RecordReceive(bool success, TickType_t waitedTicks)
+{
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+
+    if (success) {
+        receiveCount += 1;
+    }
+    else {
+        receiveTimeouts += 1;
+    }
+    receiveIdleTicks += waitedTicks;
+
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+}
+
+/**
+ * @brief Prints the statistics through CUBE_PRINT
+ * @param name Name of the queue to print
+*/
+void QueueStats::Print(const char* name) const
+{
+    // Copy so the printed values are consistent
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    const QueueStats s = *this;
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+
+    CUBE_PRINT("QUEUE %s peak %d tx %lu rx %lu txfail %lu rxtimeout %lu txblock %lu (max %lu) rxidle %lu ticks\r\n",
+        name, s.peakDepth, s.sendCount, s.receiveCount, s.sendFailures, s.receiveTimeouts,
+        s.sendBlockTicks, s.maxSendBlockTicks, s.receiveIdleTicks);
+}
+
+/**
+ * @brief Clears every statistic
+*/
+void QueueStats::Clear()
+{
+    UBaseType_t savedMask = taskENTER_CRITICAL_FROM_ISR();
+    *this = QueueStats();
+    taskEXIT_CRITICAL_FROM_ISR(savedMask);
+}
+
+#endif /* QUEUE_INSTRUMENTATION */
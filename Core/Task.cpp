@@ -13,17 +13,256 @@ Task::Task(void)
 {
     qEvtQueue = new Queue();
     rtTaskHandle = nullptr;
+#if (configUSE_QUEUE_SETS == 1)
+    rtQueueSetHandle = nullptr;
+    numEventSources = 0;
+#endif
 }
 
 /**
  * @brief Constructor with queue depth
  * @param depth Optionally 0, uses the given depth for the event queue
+ * @param itemMode Item mode of the event queue, QUEUE_ITEM_HANDLE queues CommandSlotTable handles only
 */
-Task::Task(uint16_t depth)
+Task::Task(uint16_t depth, QueueItemMode itemMode)
 {
     if (depth == 0)
         qEvtQueue = nullptr;
     else
-        qEvtQueue = new Queue(depth);
+        qEvtQueue = new Queue(depth, itemMode);
     rtTaskHandle = nullptr;
+#if (configUSE_QUEUE_SETS == 1)
+    rtQueueSetHandle = nullptr;
+    numEventSources = 0;
+#endif
 }
+
+/**
+ * @brief Constructor with queue depth and backpressure policy
+ * @param depth Optionally 0, uses the given depth for the event queue
+ * @param policy What sending to the event queue does when it is full, see QueueBackpressurePolicy
+ * @param sendTimeout_ms Time a send waits for space with QUEUE_POLICY_BLOCK
+ * @param itemMode Item mode of the event queue, QUEUE_ITEM_HANDLE queues CommandSlotTable handles only
+*/
+Task::Task(uint16_t depth, QueueBackpressurePolicy policy, uint32_t sendTimeout_ms, QueueItemMode itemMode)
+{
+    if (depth == 0)
+        qEvtQueue = nullptr;
+    else
+        qEvtQueue = new Queue(depth, policy, sendTimeout_ms, itemMode);
+    rtTaskHandle = nullptr;
+#if (configUSE_QUEUE_SETS == 1)
+    rtQueueSetHandle = nullptr;
+    numEventSources = 0;
+#endif
+}
+
+/**
+ * @brief Constructor with an event queue owned elsewhere, no heap allocation is made
+ * @param queue Event queue of the task, eg. a StaticQueue, must outlive the task
+*/
+Task::Task(Queue& queue)
+{
+    qEvtQueue = &queue;
+    rtTaskHandle = nullptr;
+#if (configUSE_QUEUE_SETS == 1)
+    rtQueueSetHandle = nullptr;
+    numEventSources = 0;
+#endif
+}
+
+/**
+ * @brief Broadcasts a command to the event queue of every given task. The payload is not copied, each
+ *        recipient receives a Command referencing the same data (see Command::ShareDataWith). Exclusively
+ *        owned data (AllocateData / CopyDataToCommand, segments) is copied once into a shared block first,
+ *        so prefer Command::AllocateSharedData / CopyDataToSharedCommand for payloads that are broadcast.
+ *        The caller's reference is always released (cmd is reset), the payload is freed once every
+ *        recipient has reset its copy.
+ * @param cmd Command to broadcast
+ * @param tasks Array of tasks to send the command to, nullptr entries and tasks without a queue are skipped
+ * @param numTasks Number of entries in tasks
+ * @return Number of tasks the command was successfully sent to
+*/
+uint16_t Task::Broadcast(Command& cmd, Task* const tasks[], uint16_t numTasks)
+{
+    uint16_t numSent = 0;
+
+    // Promote exclusively owned data once so every recipient can reference it
+    cmd.MakeShared();
+
+    for (uint16_t i = 0; i < numTasks; i++) {
+        if (tasks[i] == nullptr || tasks[i]->GetEventQueue() == nullptr) {
+            continue;
+        }
+
+        // Each recipient gets its own Command object referencing the same payload
+        Command recipientCmd(cmd.GetCommand(), cmd.GetTaskCommand());
+        const bool shared = cmd.ShareDataWith(recipientCmd);
+        CUBE_ASSERT(shared, "Task::Broadcast - Command data cannot be shared");
+
+        // Send resets the recipient copy (releasing its reference) on failure
+        if (tasks[i]->GetEventQueue()->Send(recipientCmd)) {
+            numSent++;
+        }
+    }
+
+    // Release the broadcaster's reference
+    cmd.Reset();
+
+    return numSent;
+}
+
+#if (configUSE_QUEUE_SETS == 1)
+/**
+ * @brief Registers a Queue (eg. the task event queue) as an event source, the handler must receive exactly one Command
+ * @param queue Queue to wait on
+ * @param handler Handler called when the queue holds a Command
+ * @param context Passed to the handler
+ * @return TRUE on success, FALSE if the source table is full or the event set has already been started
+*/
+bool Task::AddEventSource(Queue& queue, TaskEventHandler handler, void* context)
+{
+    return AddEventSource(queue.GetRTOSHandle(), queue.GetQueueDepth(), handler, context);
+}
+
+/**
+ * @brief Registers a TQueue as an event source, the handler must receive exactly one item
+ * @param queue TQueue to wait on
+ * @param handler Handler called when the queue holds an item
+ * @param context Passed to the handler
+ * @return TRUE on success, FALSE if the source table is full or the event set has already been started
+*/
+bool Task::AddEventSource(QueueCore& queue, TaskEventHandler handler, void* context)
+{
+    return AddEventSource(queue.GetRTOSHandle(), queue.GetQueueDepth(), handler, context);
+}
+
+/**
+ * @brief Registers a PQueue or DeadlineQueue as an event source, the handler must make exactly one Receive call
+ *        without blocking. A DeadlineQueue dropping expired items may then find no item, Receive returns false.
+ * @param queue PQueue or DeadlineQueue to wait on
+ * @param handler Handler called when the queue holds an item
+ * @param context Passed to the handler
+ * @return TRUE on success, FALSE if the source table is full or the event set has already been started
+*/
+bool Task::AddEventSource(PQueueCore& queue, TaskEventHandler handler, void* context)
+{
+    return AddEventSource(queue.GetRTOSHandle(), queue.GetMaxDepth(), handler, context);
+}
+
+/**
+ * @brief Registers a Mutex as an event source, the handler is called when the mutex is available and must
+ *        lock it without blocking. Priority inheritance does not apply while the task waits on the set.
+ * @param mutex Mutex to wait on
+ * @param handler Handler called when the mutex is available
+ * @param context Passed to the handler
+ * @return TRUE on success, FALSE if the source table is full or the event set has already been started
+*/
+bool Task::AddEventSource(Mutex& mutex, TaskEventHandler handler, void* context)
+{
+    return AddEventSource(mutex.GetRTOSHandle(), 1, handler, context);
+}
+
+/**
+ * @brief Registers a CommandMailbox as an event source, the handler is called while any key is pending and must
+ *        make exactly one Receive / ReceiveChanged call on the mailbox (without blocking)
+ * @param mailbox Mailbox to wait on
+ * @param handler Handler called when the mailbox has changed keys
+ * @param context Passed to the handler
+ * @return TRUE on success, FALSE if the source table is full or the event set has already been started
+*/
+bool Task::AddEventSource(CommandMailbox& mailbox, TaskEventHandler handler, void* context)
+{
+    return AddEventSource(mailbox.GetRTOSHandle(), 1, handler, context);
+}
+
+/**
+ * @brief Registers any RTOS queue or semaphore as an event source
+ * @param source RTOS queue or semaphore handle
+ * @param length Queue depth, or the max count of a semaphore (1 for binary semaphores)
+ * @param handler Handler called when the source holds an item, it must take exactly one item from the source
+ * @param context Passed to the handler
+ * @return TRUE on success, FALSE if the source table is full or the event set has already been started
+*/
+bool Task::AddEventSource(QueueSetMemberHandle_t source, uint16_t length, TaskEventHandler handler, void* context)
+{
+    if (rtQueueSetHandle != nullptr || numEventSources >= TASK_MAX_EVENT_SOURCES || source == nullptr || handler == nullptr) {
+        return false;
+    }
+
+    eventSources[numEventSources++] = { source, length, handler, context };
+    return true;
+}
+
+/**
+ * @brief Creates the queue set sized for every registered source and adds the sources to it. Every source
+ *        must be empty (semaphores taken) when this is called, call it from InitTask or the start of Run.
+ * @return TRUE on success, FALSE on failure
+*/
+bool Task::StartEventSet()
+{
+    if (rtQueueSetHandle != nullptr || numEventSources == 0) {
+        return false;
+    }
+
+    uint16_t setLength = 0;
+    for (uint8_t i = 0; i < numEventSources; i++) {
+        setLength += eventSources[i].length;
+    }
+
+    rtQueueSetHandle = xQueueCreateSet(setLength);
+    CUBE_ASSERT(rtQueueSetHandle != nullptr, "Task::StartEventSet() - xQueueCreateSet() failed");
+
+    for (uint8_t i = 0; i < numEventSources; i++) {
+        if (xQueueAddToSet(eventSources[i].source, rtQueueSetHandle) != pdPASS) {
+            CUBE_PRINT("Task::StartEventSet() - source %d is not empty or already in a set\n", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Waits on every registered source together and calls the handler of the source that fired
+ * @param timeout_ms Time to block for
+ * @return TRUE if a handler was called, FALSE on timeout
+*/
+bool Task::DispatchEvent(uint32_t timeout_ms)
+{
+    return DispatchEventTicks(MS_TO_TICKS(timeout_ms));
+}
+
+/**
+ * @brief Blocks until a registered source fires and calls its handler
+ * @return TRUE if a handler was called, FALSE otherwise (should rarely return false)
+*/
+bool Task::DispatchEventWait()
+{
+    return DispatchEventTicks(HAL_MAX_DELAY);
+}
+
+/**
+ * @brief Waits on the queue set and dispatches to the handler of the source that fired
+*/
+bool Task::DispatchEventTicks(TickType_t waitTicks)
+{
+    if (rtQueueSetHandle == nullptr) {
+        return false;
+    }
+
+    QueueSetMemberHandle_t source = xQueueSelectFromSet(rtQueueSetHandle, waitTicks);
+    if (source == nullptr) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < numEventSources; i++) {
+        if (eventSources[i].source == source) {
+            eventSources[i].handler(eventSources[i].context, source);
+            return true;
+        }
+    }
+
+    return false;
+}
+#endif
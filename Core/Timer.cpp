@@ -40,6 +40,19 @@ Timer::Timer(void (*TimerDefaultCallback_t)( TimerHandle_t xTimer ))
     timerState = UNINITIALIZED;
 }
 
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+/**
+ * Constructor for statically allocated timers (see StaticTimer), same default behaviour as the other constructors
+ * The timer is created inside the given control block storage instead of the FreeRTOS heap
+*/
+Timer::Timer(StaticTimer_t* rtTimerBuffer, void (*TimerDefaultCallback_t)( TimerHandle_t xTimer ))
+{
+    rtTimerHandle = xTimerCreateStatic("Timer", timerPeriod, pdFALSE, (void *)this, TimerDefaultCallback_t, rtTimerBuffer);
+    CUBE_ASSERT(rtTimerHandle, "Error Occurred, Timer not created");
+    timerState = UNINITIALIZED;
+}
+#endif
+
 /**
  * @brief Default de-constructor makes a timer that can only be polled for state
  * @return Prints a success message if the timer is successfully deleted and a warning message if it was not deleted
@@ -0,0 +1,49 @@
+/**
+ ******************************************************************************
+ * File Name          : UniqueCommand.cpp
+ * Description        : Implementation of the move-only Command owner
+ ******************************************************************************
+*/
+#include "Core/Inc/UniqueCommand.hpp"
+
+/**
+ * @brief Adopts a command, the owner becomes responsible for releasing its payload
+ * @param command Command to adopt, left as an empty COMMAND_NONE command
+*/
+UniqueCommand::UniqueCommand(Command& command)
+{
+    cmd = command;
+    command = Command();
+}
+
+/**
+ * @brief Move constructor, takes the command of the other owner and leaves it empty
+*/
+UniqueCommand::UniqueCommand(UniqueCommand&& other)
+{
+    cmd = other.cmd;
+    other.Disown();
+}
+
+/**
+ * @brief Move assignment, releases the current payload then takes the command of the other owner
+*/
+UniqueCommand& UniqueCommand::operator=(UniqueCommand&& other)
+{
+    if (this != &other) {
+        cmd.Reset();
+        cmd = other.cmd;
+        other.Disown();
+    }
+    return *this;
+}
+
+/**
+ * @brief Moves the command out of the owner, the owner is left empty
+ * @param target Command to move into, must not hold data as it is overwritten without being reset
+*/
+void UniqueCommand::Release(Command& target)
+{
+    target = cmd;
+    Disown();
+}
@@ -9,13 +9,19 @@
 
 #include "Core/Inc/Mutex.hpp"
 #include "Core/Inc/Command.hpp"
+#include "Core/Inc/CommandLoan.hpp"
 #include "Drivers/Inc/UARTDriver.hpp"
 #include "CubeDefines.hpp"
 #include "SystemDefines.hpp"
 #include "CubeTask.hpp"
 
 /* Global Variables ------------------------------------------------------------------*/
+#ifdef CUBE_STATIC_ALLOCATION
+static StaticSemaphore_t vaListMutexBuffer;    // Static storage of vaListMutex
+Mutex Global::vaListMutex(&vaListMutexBuffer);
+#else
 Mutex Global::vaListMutex;
+#endif
 
 /* System Functions ------------------------------------------------------------*/
 /**
@@ -26,34 +32,34 @@ Mutex Global::vaListMutex;
 void cube_print(const char* str, ...)
 {
 #ifndef DISABLE_DEBUG
-    //Try to take the VA list mutex
-    if (Global::vaListMutex.Lock(DEBUG_TAKE_MAX_TIME_MS)) {
-        // If we have a message, and can use VA list, extract the string into a new buffer, and null terminate it
-        uint8_t str_buffer[DEBUG_PRINT_MAX_SIZE] = {};
-        va_list argument_list;
-        va_start(argument_list, str);
-        int16_t buflen = vsnprintf(reinterpret_cast<char*>(str_buffer), sizeof(str_buffer) - 1, str, argument_list);
-        va_end(argument_list);
-        if (buflen > 0) {
-            str_buffer[buflen] = '\0';
-        }
+    // Borrow the payload buffer up front so the message is formatted straight into the Command payload, the commit
+    // moves the message into a pool block sized to it
+    CommandLoan loan = CubeTask::Inst().LoanDebugBuffer(DEBUG_PRINT_MAX_SIZE);
 
-        // Release the VA List Mutex
-        Global::vaListMutex.Unlock();
+    //Try to take the VA list mutex
+    if (!Global::vaListMutex.Lock(DEBUG_TAKE_MAX_TIME_MS)) {
+        // Print out that we could not acquire the VA list mutex
+        CUBE_ASSERT(false, "Could not acquire VA_LIST mutex");
+        return;
+    }
 
-        //Generate a command
-        Command cmd(DATA_COMMAND, (uint16_t)CUBE_TASK_COMMAND_SEND_DEBUG); // Set the UART channel to send data on
+    // If we have a message, and can use VA list, format the string into the loaned buffer (null terminated by vsnprintf)
+    va_list argument_list;
+    va_start(argument_list, str);
+    int16_t buflen = vsnprintf(reinterpret_cast<char*>(loan.GetBuffer()), loan.GetSize(), str, argument_list);
+    va_end(argument_list);
 
-        //Copy data into the command
-        cmd.CopyDataToCommand(str_buffer, buflen);
+    // Release the VA List Mutex
+    Global::vaListMutex.Unlock();
 
-        //Send this packet off to the UART Task
-        CubeTask::Inst().GetEventQueue()->Send(cmd, false);
+    // Clamp truncated messages to the buffer, the null terminator is not sent
+    if (buflen >= static_cast<int16_t>(loan.GetSize())) {
+        buflen = loan.GetSize() - 1;
     }
-    else
-    {
-        // Print out that we could not acquire the VA list mutex
-        CUBE_ASSERT(false, "Could not acquire VA_LIST mutex");
+
+    //Send this packet off to the UART Task, the loan is released if there is nothing to send or the send fails
+    if (buflen > 0) {
+        CubeTask::Inst().CommitDebugBuffer(loan, buflen);
     }
 #endif
 }
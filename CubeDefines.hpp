@@ -13,8 +13,10 @@
 
 /* System Wide Includes ------------------------------------------------------------------*/
 #include "CubeUtils.hpp"  // Utility functions
+#include <cstddef>        // For size_t, max_align_t
 #include <cstdint>        // For uint32_t, etc.
 #include <cstdio>        // Standard c printf, vsnprintf, etc.
+#include <new>           // For std::align_val_t
 #include "cmsis_os.h"    // CMSIS RTOS definitions
 
 /* Global Functions ------------------------------------------------------------------*/
@@ -85,9 +87,31 @@ inline void cube_free(void* ptr) {
 }
 
 /* Other ------------------------------------------------------------------*/
-// Override the new and delete operator to ensure heap4 is used for dynamic memory allocation
+// Alignment of every cube_malloc block, aligned new asserts the requested alignment does not exceed it
+#ifdef COMPUTER_ENVIRONMENT
+constexpr size_t CUBE_HEAP_ALIGNMENT = alignof(std::max_align_t);
+#else
+constexpr size_t CUBE_HEAP_ALIGNMENT = portBYTE_ALIGNMENT;
+#endif
+
+// Override the new and delete operators to ensure heap4 is used for dynamic memory allocation, every form of delete
+// is overridden so the compiler never pairs cube_malloc with the default (sized or aligned) delete
 inline void* operator new(size_t size) { return cube_malloc(size); }
+inline void* operator new[](size_t size) { return cube_malloc(size); }
 inline void operator delete(void* ptr) { cube_free(ptr); }
+inline void operator delete[](void* ptr) { cube_free(ptr); }
+inline void operator delete(void* ptr, size_t) { cube_free(ptr); }
+inline void operator delete[](void* ptr, size_t) { cube_free(ptr); }
+
+inline void* operator new(size_t size, std::align_val_t align) {
+    CUBE_ASSERT(static_cast<size_t>(align) <= CUBE_HEAP_ALIGNMENT, "new alignment exceeds the heap alignment");
+    return cube_malloc(size);
+}
+inline void* operator new[](size_t size, std::align_val_t align) { return operator new(size, align); }
+inline void operator delete(void* ptr, std::align_val_t) { cube_free(ptr); }
+inline void operator delete[](void* ptr, std::align_val_t) { cube_free(ptr); }
+inline void operator delete(void* ptr, size_t, std::align_val_t) { cube_free(ptr); }
+inline void operator delete[](void* ptr, size_t, std::align_val_t) { cube_free(ptr); }
 
 
 #endif // CUBE_PLUSPLUS_CUBE_DEFINES_HPP_
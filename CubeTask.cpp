@@ -16,6 +16,21 @@ void CubeTask::InitTask()
     // Make sure the task is not already initialized
     CUBE_ASSERT(rtTaskHandle == nullptr, "Cannot initialize UART task twice");
 
+#ifdef COMMAND_LATENCY_TRACING
+    // Start the latency timestamp counter, the Cube task is initialized before any other task sends Commands
+    CommandLatencyTracer::Init();
+#endif
+
+#ifdef CUBE_STATIC_ALLOCATION
+    // Start the task in its static stack and TCB
+    bool created = CreateStaticTask((TaskFunction_t)CubeTask::RunTask,
+            (const char*)"CUBETask",
+            (void*)this,
+            (UBaseType_t)UART_TASK_RTOS_PRIORITY);
+
+    //Ensure creation succeded
+    CUBE_ASSERT(created, "CUBETask::InitTask() - xTaskCreateStatic() failed");
+#else
     // Start the task
     BaseType_t rtValue =
         xTaskCreate((TaskFunction_t)CubeTask::RunTask,
@@ -27,6 +42,7 @@ void CubeTask::InitTask()
 
     //Ensure creation succeded
     CUBE_ASSERT(rtValue == pdPASS, "CUBETask::InitTask() - xTaskCreate() failed");
+#endif
 }
 
 /**
@@ -36,14 +52,16 @@ void CubeTask::InitTask()
 void CubeTask::Run(void * pvParams)
 {
     //UART Task loop
+    Command cms[CUBE_TASK_RECEIVE_BATCH_SIZE];
     while(1) {
-        Command cm;
+        //Wait forever for a command, then take every command already queued in the same wakeup
+        const uint16_t numReceived = qEvtQueue->ReceiveManyWait(cms, CUBE_TASK_RECEIVE_BATCH_SIZE);
 
-        //Wait forever for a command
-        qEvtQueue->ReceiveWait(cm);
-
-        //Process the command
-        HandleCommand(cm);
+        //Process the commands, each is reset by HandleCommand
+        for (uint16_t i = 0; i < numReceived; i++) {
+            HandleCommand(cms[i]);
+            COMMAND_TRACE_HANDLED(cms[i]);
+        }
     }
 }
 
@@ -61,7 +79,7 @@ void CubeTask::HandleCommand(Command& cm)
         switch (cm.GetTaskCommand()) {
         case CUBE_TASK_COMMAND_SEND_DEBUG:
 #ifndef DISABLE_DEBUG
-                DEFAULT_DEBUG_UART_DRIVER->Transmit(cm.GetDataPointer(), cm.GetDataSize());
+                DEFAULT_DEBUG_UART_DRIVER->Transmit(cm);
 #endif
             break;
         default:
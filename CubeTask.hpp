@@ -9,6 +9,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "Task.hpp"
+#include "CommandLoan.hpp"
 #include "SystemDefines.hpp"
 #include "CubeDefines.hpp"
 #include "UARTDriver.hpp"
@@ -16,6 +17,10 @@
 
 
 /* Macros ------------------------------------------------------------------*/
+#ifndef CUBE_TASK_RECEIVE_BATCH_SIZE // Max commands taken per receive of the Cube task, 1 (default) receives one at a time
+#define CUBE_TASK_RECEIVE_BATCH_SIZE 1
+#endif
+
 enum CUBE_TASK_COMMANDS {
     CUBE_TASK_COMMAND_NONE = 0,
 
@@ -25,8 +30,15 @@ enum CUBE_TASK_COMMANDS {
 };
 
 
+#ifdef CUBE_STATIC_ALLOCATION
+static_assert(configSUPPORT_STATIC_ALLOCATION == 1, "CUBE_STATIC_ALLOCATION requires configSUPPORT_STATIC_ALLOCATION");
+typedef StaticTask<UART_TASK_QUEUE_DEPTH_OBJS, UART_TASK_STACK_DEPTH_WORDS> CubeTaskBase;    // Event queue, TCB and stack placed at link time
+#else
+typedef Task CubeTaskBase;
+#endif
+
 /* Class ------------------------------------------------------------------*/
-class CubeTask : public Task
+class CubeTask : public CubeTaskBase
 {
 public:
     static CubeTask& Inst() {
@@ -36,6 +48,10 @@ public:
 
     void InitTask();
 
+    // Debug output, the buffer is formatted in place and committed directly to the Cube task event queue
+    CommandLoan LoanDebugBuffer(uint16_t size) { return CommandLoan(DATA_COMMAND, CUBE_TASK_COMMAND_SEND_DEBUG, size); }
+    bool CommitDebugBuffer(CommandLoan& loan, uint16_t len) { return loan.Commit(*qEvtQueue, len, false); }
+
 protected:
     static void RunTask(void* pvParams) { CubeTask::Inst().Run(pvParams); } // Static Task Interface, passes control to the instance Run();
 
@@ -44,7 +60,11 @@ protected:
     void HandleCommand(Command& cm);
 
 private:
+#ifdef CUBE_STATIC_ALLOCATION
+    CubeTask() {}                                     // Private constructor
+#else
     CubeTask() : Task(UART_TASK_QUEUE_DEPTH_OBJS) {}    // Private constructor
+#endif
     CubeTask(const CubeTask&);                        // Prevent copy-construction
     CubeTask& operator=(const CubeTask&);            // Prevent assignment
 };
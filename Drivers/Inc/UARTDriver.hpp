@@ -35,6 +35,8 @@ namespace UART {
 }
 #endif
 
+class Command;
+
 /* UART Receiver Base Class ------------------------------------------------------------------*/
 /**
  * @brief Any classes that are expected to receive using a UART driver
@@ -63,6 +65,7 @@ public:
 
 	// Polling Functions
 	bool Transmit(uint8_t* data, uint16_t len);
+	bool Transmit(const Command& cm); // Transmits every segment of a Command payload, without flattening
 
 	// Interrupt Functions
 	bool ReceiveIT(uint8_t* charBuf, UARTReceiverBase* receiver);
@@ -73,6 +76,8 @@ public:
 
 protected:
 	// Helper Functions
+	void TransmitBytes(const uint8_t* data, uint16_t len);
+	void WaitTransmitComplete();
 	bool HandleAndClearRxError();
 	bool GetRxErrors();
 
@@ -13,6 +13,7 @@
  ******************************************************************************
 */
 #include "UARTDriver.hpp"
+#include "Core/Inc/Command.hpp"
 
 /**
  * @brief Transmits data via polling
@@ -21,6 +22,38 @@
  * @return True if the transmission was successful, false otherwise
  */
 bool UARTDriver::Transmit(uint8_t* data, uint16_t len)
+{
+    TransmitBytes(data, len);
+    WaitTransmitComplete();
+
+    return true;
+}
+
+/**
+ * @brief Transmits the payload of a Command via polling, segmented payloads are sent
+ *        segment by segment as one transfer so they never need to be copied together
+ * @param cm The command holding the data to transmit
+ * @return True if the transmission was successful, false otherwise
+ */
+bool UARTDriver::Transmit(const Command& cm)
+{
+    const uint8_t numSegments = cm.GetSegmentCount();
+    for (uint8_t i = 0; i < numSegments; i++) {
+        uint16_t len = 0;
+        const uint8_t* data = cm.GetSegment(i, len);
+        TransmitBytes(data, len);
+    }
+    WaitTransmitComplete();
+
+    return true;
+}
+
+/**
+ * @brief Transmits bytes via polling, does not wait for the transfer to complete
+ * @param data The data to transmit
+ * @param len The length of the data to transmit
+ */
+void UARTDriver::TransmitBytes(const uint8_t* data, uint16_t len)
 {
     // Loop through and transmit each byte via. polling
     for (uint16_t i = 0; i < len; i++) {
@@ -29,11 +62,15 @@ bool UARTDriver::Transmit(uint8_t* data, uint16_t len)
         // Wait until the TX Register Empty Flag is set
         while (!LL_USART_IsActiveFlag_TXE(kUart_)) {}
     }
+}
 
+/**
+ * @brief Waits until the last transmitted byte has left the shift register
+ */
+void UARTDriver::WaitTransmitComplete()
+{
     // Wait until the transfer complete flag is set
     while (!LL_USART_IsActiveFlag_TC(kUart_)) {}
-
-    return true;
 }
 
 /**